@@ -0,0 +1,150 @@
+#ifndef BIGINT_ACCUMULATOR_HPP
+#define BIGINT_ACCUMULATOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "forward_declare.hpp"
+#include "bigint.hpp"
+
+namespace hqythu {
+
+namespace bigint {
+
+// sum of many products without propagating carries per term.
+// every column is a double limb holding a sum of single limbs, so a column
+// takes 2^32 - 1 additions before it can overflow. partial products are
+// split into their low and high limbs and added to two columns; carries are
+// only resolved when the headroom runs out and once in result().
+// positive and negative terms go to separate columns. like BigInt, the sum
+// wraps modulo 2^N.
+template <int N>
+class BigIntAccumulator {
+private:
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef typename BigInt<N>::double_limb_type double_limb_type;
+    static const int limb_bits = BigInt<N>::limb_bits;
+
+    std::vector<double_limb_type> pos;
+    std::vector<double_limb_type> neg;
+    // additions a column may have received since the last normalization.
+    double_limb_type pos_load;
+    double_limb_type neg_load;
+
+    static void normalize(std::vector<double_limb_type>& cols);
+    void reserve(bool positive, double_limb_type terms);
+
+public:
+    BigIntAccumulator();
+
+    void clear();
+
+    void add(const BigInt<N>& a);
+    void addmul(const BigInt<N>& a, const BigInt<N>& b);
+    void addmul(const BigInt<N>& a, limb_type b);
+
+    BigInt<N> result() const;
+};
+
+template <int N>
+BigIntAccumulator<N>::BigIntAccumulator()
+        : pos(BigInt<N>::N_limbs, 0), neg(BigInt<N>::N_limbs, 0), pos_load(0), neg_load(0) {}
+
+template <int N>
+void BigIntAccumulator<N>::clear() {
+    std::fill(pos.begin(), pos.end(), 0);
+    std::fill(neg.begin(), neg.end(), 0);
+    pos_load = neg_load = 0;
+}
+
+template <int N>
+void BigIntAccumulator<N>::normalize(std::vector<double_limb_type>& cols) {
+    double_limb_type carry = 0;
+    for (double_limb_type& c : cols) {
+        carry += c;
+        c = static_cast<limb_type>(carry);
+        carry >>= limb_bits;
+    }
+}
+
+// makes room for `terms` more additions in every column of one sign.
+template <int N>
+void BigIntAccumulator<N>::reserve(bool positive, double_limb_type terms) {
+    const double_limb_type headroom = static_cast<limb_type>(-1);
+    double_limb_type& load = positive ? pos_load : neg_load;
+    if (load + terms > headroom) {
+        normalize(positive ? pos : neg);
+        load = 1;
+    }
+    load += terms;
+}
+
+template <int N>
+void BigIntAccumulator<N>::add(const BigInt<N>& a) {
+    reserve(a.get_sign(), 1);
+    std::vector<double_limb_type>& cols = a.get_sign() ? pos : neg;
+    const limb_type* pa = a.get_data();
+    for (int i = 0; i < a.get_len(); i++) {
+        cols[i] += pa[i];
+    }
+}
+
+template <int N>
+void BigIntAccumulator<N>::addmul(const BigInt<N>& a, const BigInt<N>& b) {
+    const bool positive = (a.get_sign() == b.get_sign());
+    const int a_len = a.get_len(), b_len = b.get_len();
+    reserve(positive, 2 * static_cast<double_limb_type>(std::min(a_len, b_len)));
+    std::vector<double_limb_type>& cols = positive ? pos : neg;
+    const int n = static_cast<int>(cols.size());
+    const limb_type* pa = a.get_data();
+    const limb_type* pb = b.get_data();
+    for (int i = 0; i < a_len && i < n; i++) {
+        const double_limb_type ai = pa[i];
+        double_limb_type* col = cols.data() + i;
+        const int j_end = std::min(b_len, n - i);
+        for (int j = 0; j < j_end; j++) {
+            double_limb_type p = ai * pb[j];
+            col[j] += static_cast<limb_type>(p);
+            if (i + j + 1 < n) {
+                col[j + 1] += p >> limb_bits;
+            }
+        }
+    }
+}
+
+template <int N>
+void BigIntAccumulator<N>::addmul(const BigInt<N>& a, limb_type b) {
+    reserve(a.get_sign(), 2);
+    std::vector<double_limb_type>& cols = a.get_sign() ? pos : neg;
+    const int n = static_cast<int>(cols.size());
+    const limb_type* pa = a.get_data();
+    for (int i = 0; i < a.get_len() && i < n; i++) {
+        double_limb_type p = static_cast<double_limb_type>(pa[i]) * b;
+        cols[i] += static_cast<limb_type>(p);
+        if (i + 1 < n) {
+            cols[i + 1] += p >> limb_bits;
+        }
+    }
+}
+
+template <int N>
+BigInt<N> BigIntAccumulator<N>::result() const {
+    std::vector<double_limb_type> p = pos, m = neg;
+    normalize(p);
+    normalize(m);
+    BigInt<N> rp, rm;
+    for (int i = 0; i < BigInt<N>::N_limbs; i++) {
+        rp.data[i] = static_cast<limb_type>(p[i]);
+        rm.data[i] = static_cast<limb_type>(m[i]);
+    }
+    rp.len = rm.len = BigInt<N>::N_limbs;
+    rp.normalize();
+    rm.normalize();
+    return rp - rm;
+}
+
+}
+
+}
+
+#endif //BIGINT_ACCUMULATOR_HPP
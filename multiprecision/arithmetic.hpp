@@ -10,15 +10,29 @@
 #include <algorithm>
 #include <numeric>
 #include <functional>
+#include <thread>
 #include <iostream>
 #include <utility>
+#include <vector>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(BIGINT_NO_X86_KERNELS)
+#define BIGINT_X86_KERNELS 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 #include "forward_declare.hpp"
 #include "bigint.hpp"
+#include "parallel.hpp"
+#include "scratch.hpp"
 
 namespace {
 
 using std::pair;
+using hqythu::bigint::ScratchArena;
+using hqythu::bigint::ScratchFrame;
+using hqythu::bigint::scratch_bytes;
 
 template <class limb_type>
 int compare_unsigned(const limb_type* a, int a_len, const limb_type* b, int b_len) {
@@ -67,8 +81,8 @@ int raw_add(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_t
 
     double_limb_type carry = 0;
 
-    int res_len = std::max(a_len, b_len);
-    int overlap_len = std::min(a_len, b_len);
+    int res_len = std::min(std::max(a_len, b_len), max_len);
+    int overlap_len = std::min(std::min(a_len, b_len), res_len);
 
     const limb_type *pa = a;
     const limb_type *pb = b;
@@ -113,8 +127,8 @@ int raw_sub(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_t
 
     double_limb_type borrow = 0;
 
-    int res_len = std::max(a_len, b_len);
-    int overlap_len = std::min(a_len, b_len);
+    int res_len = std::min(std::max(a_len, b_len), max_len);
+    int overlap_len = std::min(std::min(a_len, b_len), res_len);
 
     int c = compare_unsigned(a, a_len, b, b_len);
 
@@ -152,8 +166,65 @@ int raw_sub(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_t
     return res_len;
 };
 
+// r[0..n) += a[0..n) * b, returns the carry limb.
+template <class limb_type, class double_limb_type>
+limb_type raw_addmul_1(limb_type* r, const limb_type* a, int n, limb_type b) {
+    const int limb_bits = sizeof(limb_type) * 8;
+    double_limb_type carry = 0;
+    for (int j = 0; j < n; j++) {
+        carry += static_cast<double_limb_type>(a[j]) * static_cast<double_limb_type>(b) + r[j];
+        r[j] = static_cast<limb_type>(carry);
+        carry >>= limb_bits;
+    }
+    return static_cast<limb_type>(carry);
+}
+
+// result may alias a.
+template <class limb_type>
+int raw_shl(const limb_type* a, int a_len, int shift, limb_type* result, int max_len) {
+    const int limb_bits = sizeof(limb_type) * 8;
+    const int limb_shift = shift / limb_bits;
+    const int bit_shift = shift % limb_bits;
+    int res_len = std::min(a_len + limb_shift + 1, max_len);
+    for (int i = res_len - 1; i >= limb_shift; i--) {
+        int j = i - limb_shift;
+        limb_type v = 0;
+        if (j < a_len) {
+            v = a[j] << bit_shift;
+        }
+        if (bit_shift && j > 0 && j - 1 < a_len) {
+            v |= a[j - 1] >> (limb_bits - bit_shift);
+        }
+        result[i] = v;
+    }
+    std::fill(result, result + std::min(limb_shift, res_len), 0);
+    return normalize(result, std::max(res_len, 1));
+}
+
+// result may alias a.
+template <class limb_type>
+int raw_shr(const limb_type* a, int a_len, int shift, limb_type* result) {
+    const int limb_bits = sizeof(limb_type) * 8;
+    const int limb_shift = shift / limb_bits;
+    const int bit_shift = shift % limb_bits;
+    if (a_len <= limb_shift) {
+        result[0] = 0;
+        return 1;
+    }
+    int res_len = a_len - limb_shift;
+    for (int i = 0; i < res_len; i++) {
+        limb_type v = a[i + limb_shift] >> bit_shift;
+        if (bit_shift && i + limb_shift + 1 < a_len) {
+            v |= a[i + limb_shift + 1] << (limb_bits - bit_shift);
+        }
+        result[i] = v;
+    }
+    return normalize(result, res_len);
+}
+
+// portable schoolbook multiplication, also the reference for the x86 kernels.
 template <class limb_type, class double_limb_type>
-int raw_mul(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len) {
+int raw_mul_portable(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len) {
     const int limb_bits = sizeof(limb_type) * 8;
 
     std::fill(result, result + max_len, 0);
@@ -193,55 +264,154 @@ int raw_mul(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_t
     return res_len;
 }
 
+#ifdef BIGINT_X86_KERNELS
+
+// cpuid leaf 7: ebx bit 8 is BMI2 (mulx), ebx bit 19 is ADX (adcx/adox).
+inline bool cpu_has_mulx_adx() {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) < 7) {
+        return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & (1u << 8)) && (ebx & (1u << 19));
+}
+
+// r[0..n) += a[0..n) * b, returns the carry word.
+// the high half of the previous product goes in through the CF chain (adcx)
+// and r[j] through the OF chain (adox), so the two additions do not
+// serialize. the loop counts with lea/jrcxz, which leave both flags alone.
+// written in asm because compilers lower _addcarryx_u64 to a single adc chain.
+inline uint64_t addmul_1_mulx_adx(uint64_t* r, const uint64_t* a, int n, uint64_t b) {
+    uint64_t lo, hi, hi_prev, zero;
+    uint64_t count = static_cast<uint64_t>(n);
+    __asm__ volatile(
+            "xorl %k[zero], %k[zero]\n\t"
+            "xorl %k[hi_prev], %k[hi_prev]\n\t"
+            "1:\n\t"
+            "jrcxz 2f\n\t"
+            "mulx (%[a]), %[lo], %[hi]\n\t"
+            "adcx %[hi_prev], %[lo]\n\t"
+            "adox (%[r]), %[lo]\n\t"
+            "movq %[lo], (%[r])\n\t"
+            "movq %[hi], %[hi_prev]\n\t"
+            "leaq 8(%[a]), %[a]\n\t"
+            "leaq 8(%[r]), %[r]\n\t"
+            "leaq -1(%[count]), %[count]\n\t"
+            "jmp 1b\n\t"
+            "2:\n\t"
+            "adcx %[zero], %[hi_prev]\n\t"
+            "adox %[zero], %[hi_prev]\n\t"
+            : [r] "+r"(r), [a] "+r"(a), [count] "+c"(count), [lo] "=&r"(lo), [hi] "=&r"(hi),
+              [hi_prev] "=&r"(hi_prev), [zero] "=&r"(zero)
+            : "d"(b)
+            : "cc", "memory");
+    return hi_prev;
+}
+
+// multiplies 32 bit limb vectors two limbs at a time as 64 bit words.
+__attribute__((target("bmi2,adx")))
+inline int raw_mul_mulx_adx(const uint32_t* a, int a_len, const uint32_t* b, int b_len, uint32_t* result, int max_len,
+                            ScratchArena& arena) {
+    ScratchFrame frame(arena);
+    int na = (a_len + 1) / 2;
+    int nb = (b_len + 1) / 2;
+    uint64_t* wa = frame.allocate<uint64_t>(na);
+    uint64_t* wb = frame.allocate<uint64_t>(nb);
+    uint64_t* wr = frame.allocate<uint64_t>(na + nb);
+    wa[na - 1] = 0;
+    wb[nb - 1] = 0;
+    std::fill(wr, wr + na + nb, 0);
+    std::memcpy(wa, a, a_len * sizeof(uint32_t));
+    std::memcpy(wb, b, b_len * sizeof(uint32_t));
+    for (int i = 0; i < na; i++) {
+        wr[i + nb] = addmul_1_mulx_adx(wr + i, wb, nb, wa[i]);
+    }
+    int res_len = std::min(max_len, a_len + b_len);
+    std::fill(result, result + max_len, 0);
+    std::memcpy(result, wr, res_len * sizeof(uint32_t));
+    return normalize(result, res_len);
+}
+
+#endif
+
+// selects the multiplication kernel for a limb type, the portable loop unless
+// a faster one exists for this target.
 template <class limb_type, class double_limb_type>
-int raw_mul_karatsuba(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len) {
-    const int limb_bits = sizeof(limb_type) * 8;
+struct mul_kernel {
+    static int mul(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len,
+                   ScratchArena&) {
+        return raw_mul_portable<limb_type, double_limb_type>(a, a_len, b, b_len, result, max_len);
+    }
+};
+
+#ifdef BIGINT_X86_KERNELS
+
+template <>
+struct mul_kernel<uint32_t, uint64_t> {
+    static int mul(const uint32_t* a, int a_len, const uint32_t* b, int b_len, uint32_t* result, int max_len,
+                   ScratchArena& arena) {
+        static const bool use_mulx_adx = cpu_has_mulx_adx();
+        if (use_mulx_adx) {
+            return raw_mul_mulx_adx(a, a_len, b, b_len, result, max_len, arena);
+        }
+        return raw_mul_portable<uint32_t, uint64_t>(a, a_len, b, b_len, result, max_len);
+    }
+};
 
+#endif
+
+template <class limb_type, class double_limb_type>
+int raw_mul(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len,
+            ScratchArena& arena = ScratchArena::local()) {
+    return mul_kernel<limb_type, double_limb_type>::mul(a, a_len, b, b_len, result, max_len, arena);
+}
+
+// scratch bytes raw_mul takes from the arena.
+inline size_t raw_mul_scratch_size(int a_len, int b_len) {
+    int na = (a_len + 1) / 2;
+    int nb = (b_len + 1) / 2;
+    return scratch_bytes<uint64_t>(na) + scratch_bytes<uint64_t>(nb) + scratch_bytes<uint64_t>(na + nb);
+}
+
+// below this many limbs schoolbook multiplication is faster than recursing.
+const int karatsuba_threshold_limbs = 32;
+
+template <class limb_type, class double_limb_type>
+int raw_mul_karatsuba(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len,
+                      ScratchArena& arena = ScratchArena::local()) {
     if (a_len == 0 || b_len == 0) {
-        result[0] = 0;
+        std::fill(result, result + max_len, 0);
         return 1;
     }
 
-    int m = 1 << static_cast<int>(std::log2(std::max(a_len - 1, b_len - 1)));
-
-    if (a_len <= 1 && b_len <= 1) {
-        double_limb_type carry = static_cast<double_limb_type>(*a) * static_cast<double_limb_type>(*b);
-        result[0] = static_cast<limb_type>(carry);
-        if (max_len > 1) {
-            result[1] = static_cast<limb_type>(carry >> limb_bits);
-            if (result[1] == 0) {
-                return 1;
-            } else {
-                return 2;
-            }
-        } else {
-            return 1;
-        }
+    if (std::min(a_len, b_len) < karatsuba_threshold_limbs) {
+        return raw_mul<limb_type, double_limb_type>(a, a_len, b, b_len, result, max_len, arena);
     }
 
+    ScratchFrame frame(arena);
+
+    int m = (std::max(a_len, b_len) + 1) / 2;
+
     const limb_type* a1 = a + m;
     const limb_type* a0 = a;
     const limb_type* b1 = b + m;
     const limb_type* b0 = b;
 
-    int a0_len = std::min(a_len, m);
+    int a0_len = normalize(a0, std::min(a_len, m));
     int a1_len = std::max(0, a_len - m);
-    int b0_len = std::min(b_len, m);
+    int b0_len = normalize(b0, std::min(b_len, m));
     int b1_len = std::max(0, b_len - m);
 
-    limb_type* c2 = new limb_type[2 * m];
+    limb_type* c2 = frame.allocate<limb_type>(2 * m);
     std::fill(c2, c2 + 2 * m, 0);
-    limb_type* c1 = new limb_type[2 * m + 2];
+    limb_type* c1 = frame.allocate<limb_type>(2 * m + 2);
     std::fill(c1, c1 + 2 * m + 2, 0);
-    limb_type* c0 = new limb_type[2 * m];
+    limb_type* c0 = frame.allocate<limb_type>(2 * m);
     std::fill(c0, c0 + 2 * m, 0);
     int c0_len, c1_len, c2_len;
 
-    c2_len = raw_mul_karatsuba<limb_type, double_limb_type>(a1, a1_len, b1, b1_len, c2, 2 * m);
-    c0_len = raw_mul_karatsuba<limb_type, double_limb_type>(a0, a0_len, b0, b0_len, c0, 2 * m);
-
-    limb_type* temp1 = new limb_type[m + 1];
-    limb_type* temp2 = new limb_type[m + 1];
+    limb_type* temp1 = frame.allocate<limb_type>(m + 1);
+    limb_type* temp2 = frame.allocate<limb_type>(m + 1);
     std::fill(temp1, temp1 + m + 1, 0);
     std::fill(temp2, temp2 + m + 1, 0);
     int temp1_len, temp2_len;
@@ -249,15 +419,39 @@ int raw_mul_karatsuba(const limb_type* a, int a_len, const limb_type* b, int b_l
     temp1_len = raw_add<limb_type, double_limb_type>(a1, a1_len, a0, a0_len, temp1, m + 1);
     temp2_len = raw_add<limb_type, double_limb_type>(b1, b1_len, b0, b0_len, temp2, m + 1);
 
-    limb_type* mul = new limb_type[2 * m + 2];
+    limb_type* mul = frame.allocate<limb_type>(2 * m + 2);
     std::fill(mul, mul + 2 * m + 2, 0);
-    int mul_len = raw_mul_karatsuba<limb_type, double_limb_type>(temp1, temp1_len, temp2, temp2_len, mul, 2 * m + 2);
+    int mul_len;
+
+    // the three sub-products are independent, hand two of them to idle
+    // workers when parallel execution is enabled for this size. a task no
+    // worker took runs deferred on this thread, inside this frame, and keeps
+    // using the caller's arena.
+    if (hqythu::bigint::ParallelConfig::instance().enabled_for(a_len, b_len)) {
+        ScratchArena* caller_arena = &arena;
+        std::thread::id caller = std::this_thread::get_id();
+        auto task_arena = [caller_arena, caller]() -> ScratchArena& {
+            return std::this_thread::get_id() == caller ? *caller_arena : ScratchArena::local();
+        };
+        auto c2_task = hqythu::bigint::fork_task([=]() {
+            return raw_mul_karatsuba<limb_type, double_limb_type>(a1, a1_len, b1, b1_len, c2, 2 * m, task_arena());
+        });
+        auto c0_task = hqythu::bigint::fork_task([=]() {
+            return raw_mul_karatsuba<limb_type, double_limb_type>(a0, a0_len, b0, b0_len, c0, 2 * m, task_arena());
+        });
+        mul_len = raw_mul_karatsuba<limb_type, double_limb_type>(temp1, temp1_len, temp2, temp2_len, mul, 2 * m + 2, arena);
+        c2_len = c2_task.get();
+        c0_len = c0_task.get();
+    } else {
+        c2_len = raw_mul_karatsuba<limb_type, double_limb_type>(a1, a1_len, b1, b1_len, c2, 2 * m, arena);
+        c0_len = raw_mul_karatsuba<limb_type, double_limb_type>(a0, a0_len, b0, b0_len, c0, 2 * m, arena);
+        mul_len = raw_mul_karatsuba<limb_type, double_limb_type>(temp1, temp1_len, temp2, temp2_len, mul, 2 * m + 2, arena);
+    }
 
     mul_len = raw_sub<limb_type, double_limb_type>(mul, mul_len, c2, c2_len, mul, 2 * m + 2);
     c1_len = raw_sub<limb_type, double_limb_type>(mul, mul_len, c0, c0_len, c1, 2 * m + 2);
 
-    limb_type* temp = new limb_type[max_len];
-    std::fill(temp, temp + max_len, 0);
+    limb_type* temp = frame.allocate<limb_type>(max_len);
     int temp_len;
 
     int res_len;
@@ -265,37 +459,82 @@ int raw_mul_karatsuba(const limb_type* a, int a_len, const limb_type* b, int b_l
 
     res_len = std::min(max_len, c0_len);
     std::copy(c0, c0 + res_len, result);
+    res_len = normalize(result, res_len);
 
-    std::copy(c1, c1 + std::min(c1_len, max_len - m), temp + m);
-    temp_len = std::min(c1_len, max_len - m) + m;
-    res_len = raw_add<limb_type, double_limb_type>(result, res_len, temp, temp_len, result, max_len);
-
-    std::fill(temp, temp + max_len, 0);
-    std::copy(c2, c2 + std::min(c2_len, max_len - 2 * m), temp + 2 * m);
-    temp_len = std::min(c2_len, max_len - 2 * m) + 2 * m;
-    res_len = raw_add<limb_type, double_limb_type>(result, res_len, temp, temp_len, result, max_len);
+    if (m < max_len) {
+        std::fill(temp, temp + max_len, 0);
+        std::copy(c1, c1 + std::min(c1_len, max_len - m), temp + m);
+        temp_len = normalize(temp, std::min(c1_len, max_len - m) + m);
+        res_len = raw_add<limb_type, double_limb_type>(result, res_len, temp, temp_len, result, max_len);
+    }
 
-    delete[] c0;
-    delete[] c1;
-    delete[] c2;
-    delete[] mul;
-    delete[] temp;
+    if (2 * m < max_len) {
+        std::fill(temp, temp + max_len, 0);
+        std::copy(c2, c2 + std::min(c2_len, max_len - 2 * m), temp + 2 * m);
+        temp_len = normalize(temp, std::min(c2_len, max_len - 2 * m) + 2 * m);
+        res_len = raw_add<limb_type, double_limb_type>(result, res_len, temp, temp_len, result, max_len);
+    }
 
     return res_len;
 }
 
+// scratch bytes raw_mul_karatsuba takes from the calling thread's arena, for
+// any operands of at most a_len and b_len limbs. operands are normalized on
+// the way down, so every call may take either branch: the bound is the
+// larger of the schoolbook branch and this call's buffers plus the largest
+// sub-product, each bounded by operands of max(a_len, b_len) / 2 + 1 limbs.
+// sub-products a worker takes use the worker's own arena.
+inline size_t raw_mul_karatsuba_scratch_size(int a_len, int b_len, int max_len, size_t limb_size) {
+    if (a_len == 0 || b_len == 0) {
+        return 0;
+    }
+    int len = std::max(a_len, b_len);
+    size_t schoolbook = raw_mul_scratch_size(len, len);
+    if (len < karatsuba_threshold_limbs) {
+        return schoolbook;
+    }
+    int m = (len + 1) / 2;
+    size_t own = 0;
+    for (int n : {2 * m, 2 * m + 2, 2 * m, m + 1, m + 1, 2 * m + 2, max_len}) {
+        own += scratch_bytes<char>(n * limb_size);
+    }
+    return std::max(schoolbook, own + raw_mul_karatsuba_scratch_size(m + 1, m + 1, 2 * m + 2, limb_size));
+}
+
+// picks the (possibly parallel) karatsuba path for operands large enough to
+// be worth splitting when parallel execution is enabled.
 template <class limb_type, class double_limb_type>
-pair<int, int> raw_div(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, limb_type* residue, int max_len) {
+int raw_mul_auto(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, int max_len,
+                 ScratchArena& arena = ScratchArena::local()) {
+    if (hqythu::bigint::ParallelConfig::instance().enabled_for(a_len, b_len)) {
+        return raw_mul_karatsuba<limb_type, double_limb_type>(a, a_len, b, b_len, result, max_len, arena);
+    }
+    return raw_mul<limb_type, double_limb_type>(a, a_len, b, b_len, result, max_len, arena);
+}
+
+template <class limb_type>
+size_t raw_mul_auto_scratch_size(int a_len, int b_len, int max_len) {
+    return std::max(raw_mul_scratch_size(a_len, b_len),
+                    raw_mul_karatsuba_scratch_size(a_len, b_len, max_len, sizeof(limb_type)));
+}
+
+template <class limb_type, class double_limb_type>
+pair<int, int> raw_div(const limb_type* a, int a_len, const limb_type* b, int b_len, limb_type* result, limb_type* residue, int max_len,
+                       ScratchArena& arena = ScratchArena::local()) {
     if (b_len == 1 && b[0] == 1) {
         std::fill(residue, residue + max_len, 0);
         std::copy(a, a + a_len, result);
         return std::make_pair(a_len, 1);
     }
-    const int N = max_len * sizeof(limb_type) * 8;
-    const int extend_len = max_len * 4;
+    // the iteration is sized by the operands, not by the capacity of the
+    // result, so small values in wide types divide at their own size.
+    const int work_len = std::min(std::max(a_len, b_len), max_len);
+    const int N = work_len * sizeof(limb_type) * 8;
+    const int extend_len = work_len * 4;
     int k = 2 * N;
-    limb_type* X = new limb_type[extend_len];
-    limb_type* D = new limb_type[extend_len];
+    ScratchFrame frame(arena);
+    limb_type* X = frame.allocate<limb_type>(extend_len);
+    limb_type* D = frame.allocate<limb_type>(extend_len);
     std::fill(X, X + extend_len, 0);
     std::fill(D, D + extend_len, 0);
     int X_len, D_len;
@@ -306,20 +545,20 @@ pair<int, int> raw_div(const limb_type* a, int a_len, const limb_type* b, int b_
     std::copy(b, b + b_len, D);
     D_len = b_len;
 
-    limb_type* temp1 = new limb_type[extend_len];
-    limb_type* temp2 = new limb_type[extend_len];
+    limb_type* temp1 = frame.allocate<limb_type>(extend_len);
+    limb_type* temp2 = frame.allocate<limb_type>(extend_len);
     std::fill(temp1, temp1 + extend_len, 0);
     std::fill(temp2, temp2 + extend_len, 0);
     int temp1_len, temp2_len;
     int k_temp2 = 0;
     while (true) {
-        temp1_len = raw_mul<limb_type, double_limb_type>(D, D_len, X, X_len, temp1, extend_len);
+        temp1_len = raw_mul_auto<limb_type, double_limb_type>(D, D_len, X, X_len, temp1, extend_len, arena);
         std::fill(temp2, temp2 + extend_len, 0);
         k_temp2 = k + 1;
         temp2[k_temp2 / (sizeof(limb_type) * 8)] = static_cast<limb_type>(1) << (k_temp2 % (sizeof(limb_type) * 8));
         temp2_len = k_temp2 / (sizeof(limb_type) * 8) + 1;
         temp1_len = raw_sub<limb_type, double_limb_type>(temp2, temp2_len, temp1, temp1_len, temp1, extend_len);
-        temp2_len = raw_mul<limb_type, double_limb_type>(X, X_len, temp1, temp1_len, temp2, extend_len);
+        temp2_len = raw_mul_auto<limb_type, double_limb_type>(X, X_len, temp1, temp1_len, temp2, extend_len, arena);
         assert(temp2_len > k / (sizeof(limb_type) * 8));
         int equal = std::inner_product(temp2 + k / (sizeof(limb_type) * 8), temp2 + temp2_len, X,
                                        0, std::plus<limb_type>(), std::not_equal_to<limb_type>());
@@ -330,17 +569,18 @@ pair<int, int> raw_div(const limb_type* a, int a_len, const limb_type* b, int b_
         }
     }
 
-    limb_type* temp = new limb_type[extend_len];
+    limb_type* temp = frame.allocate<limb_type>(extend_len);
     std::fill(temp, temp + extend_len, 0);
-    temp1_len = raw_mul<limb_type, double_limb_type>(a, a_len, X, X_len, temp1, extend_len);
-    std::copy(temp1 + k / (sizeof(limb_type) * 8), temp1 + k / (sizeof(limb_type) * 8) + max_len, result);
+    temp1_len = raw_mul_auto<limb_type, double_limb_type>(a, a_len, X, X_len, temp1, extend_len, arena);
+    std::fill(result, result + max_len, 0);
+    std::copy(temp1 + k / (sizeof(limb_type) * 8), temp1 + k / (sizeof(limb_type) * 8) + work_len, result);
     int result_len, residue_len;
     result_len = temp1_len - k / (sizeof(limb_type) * 8);
-    result_len = std::min(result_len, max_len);
-    if (result_len == 0) {
+    result_len = std::min(result_len, work_len);
+    if (result_len <= 0) {
         result_len = 1;
     }
-    int temp_len = raw_mul<limb_type, double_limb_type>(b, b_len, result, result_len, temp, max_len);
+    int temp_len = raw_mul_auto<limb_type, double_limb_type>(b, b_len, result, result_len, temp, extend_len, arena);
     residue_len = raw_sub<limb_type, double_limb_type>(a, a_len, temp, temp_len, residue, max_len);
     if (compare_unsigned(residue, residue_len, b, b_len) >= 0) {
         limb_type i = 1;
@@ -348,14 +588,58 @@ pair<int, int> raw_div(const limb_type* a, int a_len, const limb_type* b, int b_
         result_len = raw_add<limb_type, double_limb_type>(result, result_len, &i, 1, result, max_len);
     }
 
-    delete[] X;
-    delete[] D;
-    delete[] temp;
-    delete[] temp1;
-    delete[] temp2;
-
     return std::make_pair(result_len, residue_len);
 };
+
+// scratch bytes raw_div takes from the arena: five buffers of 4 * max_len
+// limbs plus the multiplications of the Newton iteration.
+template <class limb_type>
+size_t raw_div_scratch_size(int max_len) {
+    const int extend_len = max_len * 4;
+    return 5 * scratch_bytes<limb_type>(extend_len) +
+           raw_mul_auto_scratch_size<limb_type>(extend_len, extend_len, extend_len);
+}
+
+// single limb kernels for scalar operands, result may alias a.
+template <class limb_type, class double_limb_type>
+int raw_mul_limb(const limb_type* a, int a_len, limb_type b, limb_type* result, int max_len) {
+    const int limb_bits = sizeof(limb_type) * 8;
+    double_limb_type carry = 0;
+    int res_len = std::min(a_len, max_len);
+    for (int i = 0; i < res_len; i++) {
+        carry += static_cast<double_limb_type>(a[i]) * b;
+        result[i] = static_cast<limb_type>(carry);
+        carry >>= limb_bits;
+    }
+    if (carry && res_len < max_len) {
+        result[res_len++] = static_cast<limb_type>(carry);
+    }
+    return normalize(result, res_len);
+}
+
+// quotient and remainder by a single limb, from the most significant limb
+// down. returns the quotient length and the remainder.
+template <class limb_type, class double_limb_type>
+pair<int, limb_type> raw_divmod_limb(const limb_type* a, int a_len, limb_type d, limb_type* result) {
+    const int limb_bits = sizeof(limb_type) * 8;
+    double_limb_type rem = 0;
+    for (int i = a_len - 1; i >= 0; i--) {
+        rem = (rem << limb_bits) | a[i];
+        result[i] = static_cast<limb_type>(rem / d);
+        rem %= d;
+    }
+    return std::make_pair(normalize(result, a_len), static_cast<limb_type>(rem));
+}
+
+template <class limb_type, class double_limb_type>
+limb_type raw_mod_limb(const limb_type* a, int a_len, limb_type d) {
+    const int limb_bits = sizeof(limb_type) * 8;
+    double_limb_type rem = 0;
+    for (int i = a_len - 1; i >= 0; i--) {
+        rem = ((rem << limb_bits) | a[i]) % d;
+    }
+    return static_cast<limb_type>(rem);
+}
 }
 
 namespace hqythu {
@@ -363,42 +647,65 @@ namespace hqythu {
 namespace bigint {
 
 template <int N>
-int BigInt<N>::compare_unsigned(const BigInt& a, const BigInt& b) {
-    if (a.len > b.len) {
-        return 1;
-    }
-    if (a.len < b.len) {
-        return -1;
-    }
-    assert(a.len == b.len);
-    int pos_a = a.len - 1, pos_b = b.len - 1;
-    while (pos_a > 0 && pos_b > 0 && a.data[pos_a] == b.data[pos_b]) {
-        pos_a--, pos_b--;
-    }
-    if (a.data[pos_a] > b.data[pos_b]) {
-        return 1;
-    } else if (a.data[pos_a] < b.data[pos_b]) {
-        return -1;
-    } else {
-        return 0;
-    }
+template <int N1, int N2>
+int BigInt<N>::compare_unsigned(const BigInt<N1>& a, const BigInt<N2>& b) {
+    return ::compare_unsigned(a.get_data(), a.get_len(), b.get_data(), b.get_len());
 }
 
 template <int N>
-int BigInt<N>::compare(const BigInt &a, const BigInt &b) {
-    if (a.positive && b.positive) {
+template <int N1, int N2>
+int BigInt<N>::compare(const BigInt<N1>& a, const BigInt<N2>& b) {
+    if (a.get_sign() && b.get_sign()) {
         return compare_unsigned(a, b);
     }
-    if (a.positive && !b.positive) {
+    if (a.get_sign() && !b.get_sign()) {
         return 1;
     }
-    if (!a.positive && b.positive) {
+    if (!a.get_sign() && b.get_sign()) {
         return -1;
     }
-    if (!a.positive && !b.positive) {
-        return -compare_unsigned(a, b);
+    return -compare_unsigned(a, b);
+}
+
+template <int N>
+int BigInt<N>::compare_limb(const BigInt& a, limb_type b) {
+    if (!a.positive) {
+        return -1;
     }
-    return 0;
+    return ::compare_unsigned(a.data, a.len, &b, 1);
+}
+
+template <int N>
+size_t BigInt<N>::mul_scratch_size() {
+    return raw_mul_auto_scratch_size<limb_type>(N_limbs, N_limbs, N_limbs);
+}
+
+template <int N>
+size_t BigInt<N>::div_scratch_size() {
+    return raw_div_scratch_size<limb_type>(N_limbs);
+}
+
+template <int N>
+int BigInt<N>::get_bit_length() const {
+    return bit_length(data, len);
+}
+
+template <int N>
+BigInt<N> BigInt<N>::operator << (int shift) const {
+    BigInt<N> result;
+    result.len = raw_shl(data, len, shift, result.data, N_limbs);
+    result.positive = positive;
+    result.normalize();
+    return result;
+}
+
+template <int N>
+BigInt<N> BigInt<N>::operator >> (int shift) const {
+    BigInt<N> result;
+    result.len = raw_shr(data, len, shift, result.data);
+    result.positive = positive;
+    result.normalize();
+    return result;
 }
 
 template <int N>
@@ -416,62 +723,144 @@ void BigInt<N>::normalize() {
     }
 }
 
+// the arithmetic below works on the limbs of operands of any width, the
+// result must be at least as wide as both. result may alias either operand.
 template <int N>
-void BigInt<N>::add(const BigInt& a, const BigInt& b, BigInt& result) {
-    if (a.positive != b.positive) {
-        result.len = raw_sub<limb_type, double_limb_type>(a.data, a.len, b.data, b.len, result.data, N_limbs);
-        result.positive = (compare(a, b) >= 0);
+template <int N1, int N2>
+void BigInt<N>::add(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result) {
+    if (a.get_sign() != b.get_sign()) {
+        result.positive = (compare_unsigned(a, b) >= 0) ? a.get_sign() : b.get_sign();
+        result.len = raw_sub<limb_type, double_limb_type>(a.get_data(), a.get_len(), b.get_data(), b.get_len(), result.data, N_limbs);
     } else {
-        result.len = raw_add<limb_type, double_limb_type>(a.data, a.len, b.data, b.len, result.data, N_limbs);
-        result.positive = a.positive;
+        result.positive = a.get_sign();
+        result.len = raw_add<limb_type, double_limb_type>(a.get_data(), a.get_len(), b.get_data(), b.get_len(), result.data, N_limbs);
     }
     result.normalize();
 }
 
 template <int N>
-void BigInt<N>::sub(const BigInt& a, const BigInt& b, BigInt& result) {
-    if (a.positive != b.positive) {
-        result.len = raw_add<limb_type, double_limb_type>(a.data, a.len, b.data, b.len, result.data, N_limbs);
-        result.positive = a.positive;
+template <int N1, int N2>
+void BigInt<N>::sub(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result) {
+    if (a.get_sign() != b.get_sign()) {
+        result.positive = a.get_sign();
+        result.len = raw_add<limb_type, double_limb_type>(a.get_data(), a.get_len(), b.get_data(), b.get_len(), result.data, N_limbs);
     } else {
-        result.len = raw_sub<limb_type, double_limb_type>(a.data, a.len, b.data, b.len, result.data, N_limbs);
         result.positive = compare(a, b) >= 0;
+        result.len = raw_sub<limb_type, double_limb_type>(a.get_data(), a.get_len(), b.get_data(), b.get_len(), result.data, N_limbs);
     }
     result.normalize();
 }
 
 template <int N>
-void BigInt<N>::mul(const BigInt& a, const BigInt& b, BigInt& result) {
-    result.len = raw_mul<limb_type, double_limb_type>(a.data, a.len, b.data, b.len, result.data, N_limbs);
-    result.positive = (a.positive == b.positive);
+template <int N1, int N2>
+void BigInt<N>::mul(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result) {
+    mul(a, b, result, ScratchArena::local());
+}
+
+template <int N>
+template <int N1, int N2>
+void BigInt<N>::mul(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result, ScratchArena& arena) {
+    result.positive = (a.get_sign() == b.get_sign());
+    result.len = raw_mul_auto<limb_type, double_limb_type>(a.get_data(), a.get_len(), b.get_data(), b.get_len(), result.data, N_limbs, arena);
     result.normalize();
 }
 
 template <int N>
-void BigInt<N>::div(const BigInt& a, const BigInt& b, BigInt& result, BigInt& residue) {
-    auto res = raw_div<limb_type, double_limb_type>(a.data, a.len, b.data, b.len, result.data, residue.data, N_limbs);
+template <int N1, int N2>
+void BigInt<N>::div(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result, BigInt& residue) {
+    div(a, b, result, residue, ScratchArena::local());
+}
+
+template <int N>
+template <int N1, int N2>
+void BigInt<N>::div(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result, BigInt& residue, ScratchArena& arena) {
+    const bool a_positive = a.get_sign();
+    const bool b_positive = b.get_sign();
+    auto res = raw_div<limb_type, double_limb_type>(a.get_data(), a.get_len(), b.get_data(), b.get_len(), result.data, residue.data, N_limbs, arena);
     result.len = res.first;
     residue.len = res.second;
     result.positive = true;
     residue.positive = true;
-    if (!a.positive && b.positive) {
-        add(result, BigInt(1), result);
+    residue.normalize();
+    const limb_type one = 1;
+    if (residue.len == 1 && residue.data[0] == 0) {
+        // exact, no rounding toward minus infinity to do.
+        result.positive = a_positive == b_positive;
+    } else if (!a_positive && b_positive) {
+        result.len = raw_add<limb_type, double_limb_type>(result.data, result.len, &one, 1, result.data, N_limbs);
         result.positive = false;
         sub(b, residue, residue);
         residue.positive = true;
-    } else if (a.positive && !b.positive) {
-        add(result, BigInt(1), result);
+    } else if (a_positive && !b_positive) {
+        result.len = raw_add<limb_type, double_limb_type>(result.data, result.len, &one, 1, result.data, N_limbs);
         result.positive = false;
+        // |b| - residue, negated.
         add(b, residue, residue);
-        sub(BigInt(0), residue, residue);
         residue.positive = false;
-    } else if (!a.positive && !b.positive){
+    } else if (!a_positive && !b_positive){
         residue.positive = false;
     }
     result.normalize();
     residue.normalize();
 }
 
+template <int N>
+void BigInt<N>::add_limb(const BigInt& a, limb_type b, BigInt& result) {
+    if (!a.positive) {
+        result.positive = ::compare_unsigned(a.data, a.len, &b, 1) <= 0;
+        result.len = raw_sub<limb_type, double_limb_type>(a.data, a.len, &b, 1, result.data, N_limbs);
+    } else {
+        result.positive = true;
+        result.len = raw_add<limb_type, double_limb_type>(a.data, a.len, &b, 1, result.data, N_limbs);
+    }
+    result.normalize();
+}
+
+template <int N>
+void BigInt<N>::sub_limb(const BigInt& a, limb_type b, BigInt& result) {
+    if (a.positive) {
+        result.positive = ::compare_unsigned(a.data, a.len, &b, 1) >= 0;
+        result.len = raw_sub<limb_type, double_limb_type>(a.data, a.len, &b, 1, result.data, N_limbs);
+    } else {
+        result.positive = false;
+        result.len = raw_add<limb_type, double_limb_type>(a.data, a.len, &b, 1, result.data, N_limbs);
+    }
+    result.normalize();
+}
+
+template <int N>
+void BigInt<N>::mul_limb(const BigInt& a, limb_type b, BigInt& result) {
+    result.positive = a.positive;
+    result.len = raw_mul_limb<limb_type, double_limb_type>(a.data, a.len, b, result.data, N_limbs);
+    result.normalize();
+}
+
+// rounds towards negative infinity like div, the remainder is never negative.
+template <int N>
+typename BigInt<N>::limb_type BigInt<N>::divmod_limb(const BigInt& a, limb_type b, BigInt& quotient) {
+    const bool a_positive = a.positive;
+    auto res = raw_divmod_limb<limb_type, double_limb_type>(a.data, a.len, b, quotient.data);
+    quotient.len = res.first;
+    quotient.positive = a_positive;
+    limb_type rem = res.second;
+    if (!a_positive && rem) {
+        const limb_type one = 1;
+        quotient.len = raw_add<limb_type, double_limb_type>(quotient.data, quotient.len, &one, 1, quotient.data, N_limbs);
+        rem = b - rem;
+    }
+    quotient.normalize();
+    return rem;
+}
+
+template <int N>
+typename BigInt<N>::limb_type BigInt<N>::mod_limb(const BigInt& a, limb_type b) {
+    limb_type rem = raw_mod_limb<limb_type, double_limb_type>(a.data, a.len, b);
+    if (!a.positive && rem) {
+        rem = b - rem;
+    }
+    return rem;
+}
+
 }
 
 }
@@ -7,8 +7,11 @@
 
 #include <cstdint>
 #include <string>
+#include <type_traits>
 
 #include "forward_declare.hpp"
+#include "scratch.hpp"
+#include "literal.hpp"
 
 namespace hqythu {
 
@@ -24,6 +27,13 @@ private:
 
     void normalize();
 
+    template <int M>
+    friend class FixedBasePow;
+    template <int M, class Modulus>
+    friend class ModInt;
+    template <int M>
+    friend class BigIntAccumulator;
+
 public:
     static const int N_bits = N;
     static const int N_limbs;
@@ -37,6 +47,8 @@ public:
     BigInt(const std::string& v);
     template <int M>
     BigInt(const BigInt<M>& v);
+    template <int M>
+    BigInt(const BigIntConstant<M>& v);
 
     BigInt(const BigInt& op);
     BigInt(BigInt&& op);
@@ -44,18 +56,48 @@ public:
     bool get_sign() const { return positive; }
     int get_len() const { return len; }
     const limb_type* get_data() const { return data; }
+    bool get_bit(int i) const { return i / limb_bits < len && ((data[i / limb_bits] >> (i % limb_bits)) & 1); }
+    int get_bit_length() const;
 
-    static int compare(const BigInt& a, const BigInt& b);
-    static int compare_unsigned(const BigInt& a, const BigInt& b);
+    template <int N1, int N2>
+    static int compare(const BigInt<N1>& a, const BigInt<N2>& b);
+    template <int N1, int N2>
+    static int compare_unsigned(const BigInt<N1>& a, const BigInt<N2>& b);
 
-    static void add(const BigInt& a, const BigInt& b, BigInt& result);
-    static void sub(const BigInt& a, const BigInt& b, BigInt& result);
-    static void mul(const BigInt& a, const BigInt& b, BigInt& result);
-    static void div(const BigInt& a, const BigInt& b, BigInt& result, BigInt& residue);
+    template <int N1, int N2>
+    static void add(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result);
+    template <int N1, int N2>
+    static void sub(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result);
+    template <int N1, int N2>
+    static void mul(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result);
+    template <int N1, int N2>
+    static void div(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result, BigInt& residue);
+
+    // the same, taking kernel temporaries from a caller supplied arena.
+    // *_scratch_size() is the workspace in bytes one call needs at most.
+    // with parallel execution on, sub-products a worker takes use that
+    // worker's arena and every forked task allocates its shared state.
+    template <int N1, int N2>
+    static void mul(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result, ScratchArena& arena);
+    template <int N1, int N2>
+    static void div(const BigInt<N1>& a, const BigInt<N2>& b, BigInt& result, BigInt& residue, ScratchArena& arena);
+    static size_t mul_scratch_size();
+    static size_t div_scratch_size();
+
+    // single limb operands, without building a BigInt for them.
+    static int compare_limb(const BigInt& a, limb_type b);
+    static void add_limb(const BigInt& a, limb_type b, BigInt& result);
+    static void sub_limb(const BigInt& a, limb_type b, BigInt& result);
+    static void mul_limb(const BigInt& a, limb_type b, BigInt& result);
+    static limb_type divmod_limb(const BigInt& a, limb_type b, BigInt& quotient);
+    static limb_type mod_limb(const BigInt& a, limb_type b);
 
     BigInt& operator = (const BigInt& op);
     BigInt& operator = (BigInt&& op);
 
+    BigInt operator << (int shift) const;
+    BigInt operator >> (int shift) const;
+
     template <int N1, int N2>
     friend typename std::conditional<N1 >= N2, BigInt<N1>, BigInt<N2>>::type operator + (const BigInt<N1>& a, const BigInt<N2>& b);
     template <int N1, int N2>
@@ -81,6 +123,7 @@ public:
     friend bool operator >= (const BigInt<N1>& a, const BigInt<N2>& b);
 
     void from_int(int v);
+    void from_uint64(uint64_t v);
     void from_hex_string(std::string v);
     int to_int() const;
     std::string to_hex_string() const;
@@ -124,6 +167,14 @@ BigInt<N>::BigInt(const BigInt<M>& v) :BigInt() {
     std::copy(v.get_data(), v.get_data() + len, data);
 }
 
+template <int N>
+template <int M>
+BigInt<N>::BigInt(const BigIntConstant<M>& v) : BigInt() {
+    len = std::min(M / 32, N / 32);
+    std::copy(v.limbs, v.limbs + len, data);
+    normalize();
+}
+
 template <int N>
 BigInt<N>::BigInt(const BigInt &op) {
     positive = op.positive;
@@ -234,6 +285,117 @@ bool operator >= (const BigInt<N>& a, const BigInt<M>& b) {
     return higher_type::compare(a, b) >= 0;
 }
 
+// operators with an unsigned scalar. values that fit in one limb go through
+// the single limb kernels, wider ones through a two limb BigInt.
+template <class U>
+using enable_if_scalar = typename std::enable_if<std::is_unsigned<U>::value && sizeof(U) <= sizeof(uint64_t)>::type;
+
+template <int N, class U, class = enable_if_scalar<U>>
+BigInt<N> operator + (const BigInt<N>& a, U b) {
+    BigInt<N> res;
+    if (static_cast<uint64_t>(b) >> 32) {
+        BigInt<64> wide;
+        wide.from_uint64(b);
+        BigInt<N>::add(a, wide, res);
+    } else {
+        BigInt<N>::add_limb(a, static_cast<uint32_t>(b), res);
+    }
+    return res;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+BigInt<N> operator - (const BigInt<N>& a, U b) {
+    BigInt<N> res;
+    if (static_cast<uint64_t>(b) >> 32) {
+        BigInt<64> wide;
+        wide.from_uint64(b);
+        BigInt<N>::sub(a, wide, res);
+    } else {
+        BigInt<N>::sub_limb(a, static_cast<uint32_t>(b), res);
+    }
+    return res;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+BigInt<N> operator * (const BigInt<N>& a, U b) {
+    BigInt<N> res;
+    if (static_cast<uint64_t>(b) >> 32) {
+        BigInt<64> wide;
+        wide.from_uint64(b);
+        BigInt<N>::mul(a, wide, res);
+    } else {
+        BigInt<N>::mul_limb(a, static_cast<uint32_t>(b), res);
+    }
+    return res;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+BigInt<N> operator / (const BigInt<N>& a, U b) {
+    BigInt<N> q;
+    if (static_cast<uint64_t>(b) >> 32) {
+        BigInt<64> wide;
+        BigInt<N> r;
+        wide.from_uint64(b);
+        BigInt<N>::div(a, wide, q, r);
+    } else {
+        BigInt<N>::divmod_limb(a, static_cast<uint32_t>(b), q);
+    }
+    return q;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+U operator % (const BigInt<N>& a, U b) {
+    if (static_cast<uint64_t>(b) >> 32) {
+        BigInt<64> wide;
+        BigInt<N> q, r;
+        wide.from_uint64(b);
+        BigInt<N>::div(a, wide, q, r);
+        const uint32_t* d = r.get_data();
+        return static_cast<U>(r.get_len() > 1 ? (static_cast<uint64_t>(d[1]) << 32) | d[0] : d[0]);
+    }
+    return static_cast<U>(BigInt<N>::mod_limb(a, static_cast<uint32_t>(b)));
+}
+
+template <int N, class U>
+int compare_scalar(const BigInt<N>& a, U b) {
+    if (static_cast<uint64_t>(b) >> 32) {
+        BigInt<64> wide;
+        wide.from_uint64(b);
+        return BigInt<N>::compare(a, wide);
+    }
+    return BigInt<N>::compare_limb(a, static_cast<uint32_t>(b));
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+bool operator == (const BigInt<N>& a, U b) {
+    return compare_scalar(a, b) == 0;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+bool operator != (const BigInt<N>& a, U b) {
+    return compare_scalar(a, b) != 0;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+bool operator < (const BigInt<N>& a, U b) {
+    return compare_scalar(a, b) < 0;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+bool operator > (const BigInt<N>& a, U b) {
+    return compare_scalar(a, b) > 0;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+bool operator <= (const BigInt<N>& a, U b) {
+    return compare_scalar(a, b) <= 0;
+}
+
+template <int N, class U, class = enable_if_scalar<U>>
+bool operator >= (const BigInt<N>& a, U b) {
+    return compare_scalar(a, b) >= 0;
+}
+
 }
 
 }
@@ -242,5 +404,11 @@ bool operator >= (const BigInt<N>& a, const BigInt<M>& b) {
 #include "conversion.hpp"
 #include "numeric.hpp"
 #include "number_theory.hpp"
+#include "fixed_base_pow.hpp"
+#include "modint.hpp"
+#include "product_tree.hpp"
+#include "accumulator.hpp"
+#include "fixed.hpp"
+#include "modexp_engine.hpp"
 
 #endif //BIGINT_BIGINT_HPP
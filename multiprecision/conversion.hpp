@@ -25,6 +25,17 @@ void BigInt<N>::from_int(int v) {
     positive = (v >= 0);
 }
 
+template <int N>
+void BigInt<N>::from_uint64(uint64_t v) {
+    data[0] = static_cast<limb_type>(v);
+    len = 1;
+    if (N_limbs > 1 && (v >> limb_bits)) {
+        data[1] = static_cast<limb_type>(v >> limb_bits);
+        len = 2;
+    }
+    positive = true;
+}
+
 template <int N>
 void BigInt<N>::from_hex_string(string v) {
     if (v.find("-") == 0) {
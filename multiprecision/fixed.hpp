@@ -0,0 +1,359 @@
+#ifndef BIGINT_FIXED_HPP
+#define BIGINT_FIXED_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "forward_declare.hpp"
+#include "bigint.hpp"
+
+namespace hqythu {
+
+namespace bigint {
+
+// the 64 leading bits of x > 0 of L bits, i.e. floor(x * 2^(64 - L)).
+template <class T>
+uint64_t leading_bits(const T& x, int L) {
+    const uint32_t* d = x.get_data();
+    const int len = x.get_len();
+    const int top = L - 32 * (len - 1);
+    uint64_t hi = d[len - 1];
+    uint64_t mid = len > 1 ? d[len - 2] : 0;
+    uint64_t lo = len > 2 ? d[len - 3] : 0;
+    return (hi << (64 - top)) | (mid << (32 - top)) | (lo >> top);
+}
+
+// floor(sqrt(x)) of a 64 bit integer.
+inline uint64_t isqrt_u64(uint64_t x) {
+    uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(x)));
+    while (r * r > x) {
+        r--;
+    }
+    while (r < 0xffffffffu && (r + 1) * (r + 1) <= x) {
+        r++;
+    }
+    return r;
+}
+
+// (floor(2^k / d), 2^k mod d) for d > 0.
+// the same iteration x' = x + x (1 - d x) as raw_div, but it starts from a
+// 28 bit estimate by native division of the leading 32 bits of d and
+// doubles the precision at each step, using only as many leading bits of d
+// as the step needs. only the last step works at full precision, and the
+// remainder makes the quotient exact.
+// T needs about twice the bits of the quotient.
+template <class T>
+std::pair<T, T> newton_reciprocal(const T& d, int k) {
+    assert(d > 0u);
+    const int L = d.get_bit_length();
+    const int n = k - L + 1;
+    T y(0);
+    if (n > 0) {
+        // y approximates 2^(L - 1 + p) / d, a p + 1 bit number.
+        std::vector<int> precisions(1, n);
+        while (precisions.back() > 28) {
+            precisions.push_back(precisions.back() / 2 + 3);
+        }
+        int p = precisions.back();
+        // 2^(L - 1 + p) / d = 2^(31 + p) / (d * 2^(32 - L)).
+        uint64_t d32 = leading_bits(d, L) >> 32;
+        y.from_uint64((static_cast<uint64_t>(1) << (31 + p)) / d32);
+        for (int i = static_cast<int>(precisions.size()) - 2; i >= 0; i--) {
+            y = y << (precisions[i] - p);
+            p = precisions[i];
+            int s = std::max(0, L - (p + 4));
+            int kk = L - s - 1 + p;
+            // e is about 3p/2 bits, its low bits do not reach y.
+            T e = (T(1) << kk) - (d >> s) * y;
+            int c = std::max(0, kk - p - 4);
+            y = y + ((y * (e >> c)) >> (kk - c));
+        }
+    }
+    T r = (T(1) << k) - d * y;
+    while (!r.get_sign()) {
+        y = y - 1u;
+        r = r + d;
+    }
+    while (r >= d) {
+        y = y + 1u;
+        r = r - d;
+    }
+    return std::make_pair(y, r);
+}
+
+// (floor(sqrt(m)), m - floor(sqrt(m))^2) for m >= 0.
+// the reciprocal square root by z' = z + z (1 - m z^2) / 2 with doubling
+// precision from a native estimate on the leading 64 bits of m, then
+// sqrt(m) = m z, corrected to the exact floor. T needs a limb more than m.
+template <class T>
+std::pair<T, T> newton_sqrt(const T& m) {
+    assert(m.get_sign());
+    if (m == 0u) {
+        return std::make_pair(T(0), T(0));
+    }
+    const int L = m.get_bit_length();
+    const int e = (L + 1) / 2 * 2;
+    // m * 2^(64 - e), in [2^62, 2^64).
+    const uint64_t m64 = leading_bits(m, L) >> (e - L);
+    if (e <= 64) {
+        uint64_t r = isqrt_u64(m64 >> (64 - e));
+        T q, rem;
+        q.from_uint64(r);
+        rem.from_uint64((m64 >> (64 - e)) - r * r);
+        return std::make_pair(q, rem);
+    }
+    // z approximates 2^(p + e / 2) / sqrt(m), a p + 1 bit number. the shifts
+    // of m are kept even so that the scale of z does not change.
+    const int target = e / 2 + 2;
+    std::vector<int> precisions(1, target);
+    while (precisions.back() > 28) {
+        precisions.push_back(precisions.back() / 2 + 3);
+    }
+    int p = precisions.back();
+    T z;
+    z.from_uint64((static_cast<uint64_t>(1) << (p + 32)) / isqrt_u64(m64));
+    for (int i = static_cast<int>(precisions.size()) - 2; i >= 0; i--) {
+        z = z << (precisions[i] - p);
+        p = precisions[i];
+        int s = std::max(0, e - (p + 4)) / 2 * 2;
+        // m z^2 as (m z) z, dropping the bits of m z below the precision.
+        int c = std::max(0, p - 4);
+        int k = 2 * p + e - s - c;
+        T t = (T(1) << k) - (((m >> s) * z) >> c) * z;
+        c = std::max(0, k - p - 4);
+        z = z + ((z * (t >> c)) >> (k + 1 - c));
+    }
+    int s = std::max(0, e - (p + 4));
+    T q = ((m >> s) * z) >> (p + e / 2 - s);
+    T r = m - q * q;
+    while (!r.get_sign()) {
+        q = q - 1u;
+        r = r + (q << 1) + 1u;
+    }
+    while (r > (q << 1)) {
+        r = r - (q << 1) - 1u;
+        q = q + 1u;
+    }
+    return std::make_pair(q, r);
+}
+
+// fixed point number with F fractional bits, stored as BigInt<N> scaled by
+// 2^F. rounding is to nearest with ties away from zero, truncation is
+// toward zero. results that do not fit are truncated like BigInt.
+template <int N, int F>
+class BigFixed {
+    static_assert(F > 0 && F < N, "BigFixed needs 0 < F < N");
+private:
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef BigInt<2 * N> double_type;
+    typedef BigInt<4 * N> wide_type;
+
+    BigInt<N> v;
+
+    static BigInt<N> round_shift(const double_type& a, int shift);
+
+public:
+    BigFixed() {}
+    BigFixed(int x) : v(BigInt<N>(x) << F) {}
+
+    static BigFixed from_raw(const BigInt<N>& raw);
+    const BigInt<N>& raw() const { return v; }
+
+    static BigFixed mul_trunc(const BigFixed& a, const BigFixed& b);
+    static BigFixed mul_round(const BigFixed& a, const BigFixed& b);
+
+    BigFixed reciprocal() const;
+    BigFixed sqrt() const;
+
+    // digits after the point, correctly rounded.
+    std::string to_decimal_string(int digits) const;
+
+    template <int M, int G>
+    friend BigFixed<M, G> operator + (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend BigFixed<M, G> operator - (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend BigFixed<M, G> operator * (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend BigFixed<M, G> operator / (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+
+    template <int M, int G>
+    friend bool operator == (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend bool operator != (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend bool operator < (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend bool operator > (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend bool operator <= (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+    template <int M, int G>
+    friend bool operator >= (const BigFixed<M, G>& a, const BigFixed<M, G>& b);
+};
+
+template <int N, int F>
+BigInt<N> BigFixed<N, F>::round_shift(const double_type& a, int shift) {
+    double_type half = double_type(1) << (shift - 1);
+    return BigInt<N>(a.get_sign() ? (a + half) >> shift : (a - half) >> shift);
+}
+
+template <int N, int F>
+BigFixed<N, F> BigFixed<N, F>::from_raw(const BigInt<N>& raw) {
+    BigFixed r;
+    r.v = raw;
+    return r;
+}
+
+template <int N, int F>
+BigFixed<N, F> BigFixed<N, F>::mul_trunc(const BigFixed& a, const BigFixed& b) {
+    return from_raw(BigInt<N>((double_type(a.v) * b.v) >> F));
+}
+
+template <int N, int F>
+BigFixed<N, F> BigFixed<N, F>::mul_round(const BigFixed& a, const BigFixed& b) {
+    return from_raw(round_shift(double_type(a.v) * b.v, F));
+}
+
+template <int N, int F>
+BigFixed<N, F> BigFixed<N, F>::reciprocal() const {
+    assert(v != 0u);
+    wide_type d(v);
+    bool negative = !v.get_sign();
+    if (negative) {
+        d = wide_type(0) - d;
+    }
+    auto res = newton_reciprocal(d, 2 * F);
+    if (res.second >= (d - res.second)) {
+        res.first = res.first + 1u;
+    }
+    return from_raw(BigInt<N>(negative ? wide_type(0) - res.first : res.first));
+}
+
+template <int N, int F>
+BigFixed<N, F> BigFixed<N, F>::sqrt() const {
+    assert(v.get_sign());
+    auto res = newton_sqrt(wide_type(v) << F);
+    // m > q^2 + q rounds up, as (q + 1/2)^2 = q^2 + q + 1/4.
+    if (res.second > res.first) {
+        res.first = res.first + 1u;
+    }
+    return from_raw(BigInt<N>(res.first));
+}
+
+template <int N, int F>
+std::string BigFixed<N, F>::to_decimal_string(int digits) const {
+    static const limb_type powers_of_ten[] = {
+            1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u};
+    BigInt<N> mag = v.get_sign() ? v : BigInt<N>(0) - v;
+    BigInt<N> int_part = mag >> F;
+    // the fraction times 10^c stays below 2^(F + 30).
+    BigInt<N + 32> frac = mag - (int_part << F);
+
+    std::string frac_digits;
+    while (static_cast<int>(frac_digits.size()) < digits) {
+        int c = std::min(9, digits - static_cast<int>(frac_digits.size()));
+        frac = frac * powers_of_ten[c];
+        BigInt<N + 32> chunk = frac >> F;
+        frac = frac - (chunk << F);
+        std::string s = std::to_string(chunk.get_data()[0]);
+        frac_digits += std::string(c - s.length(), '0') + s;
+    }
+    // what is left is below one unit of the last digit, round on its top bit.
+    if (frac.get_bit(F - 1)) {
+        int i = digits - 1;
+        while (i >= 0 && frac_digits[i] == '9') {
+            frac_digits[i--] = '0';
+        }
+        if (i >= 0) {
+            frac_digits[i]++;
+        } else {
+            int_part = int_part + 1u;
+        }
+    }
+
+    std::vector<limb_type> chunks;
+    BigInt<N> q;
+    do {
+        chunks.push_back(BigInt<N>::divmod_limb(int_part, powers_of_ten[9], q));
+        int_part = q;
+    } while (int_part != 0u);
+    std::string str = std::to_string(chunks.back());
+    for (int i = static_cast<int>(chunks.size()) - 2; i >= 0; i--) {
+        std::string s = std::to_string(chunks[i]);
+        str += std::string(9 - s.length(), '0') + s;
+    }
+    if (digits > 0) {
+        str += "." + frac_digits;
+    }
+    if (!v.get_sign() && str.find_first_not_of("0.") != std::string::npos) {
+        str.insert(0, "-");
+    }
+    return str;
+}
+
+template <int N, int F>
+BigFixed<N, F> operator + (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return BigFixed<N, F>::from_raw(a.v + b.v);
+}
+
+template <int N, int F>
+BigFixed<N, F> operator - (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return BigFixed<N, F>::from_raw(a.v - b.v);
+}
+
+template <int N, int F>
+BigFixed<N, F> operator * (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return BigFixed<N, F>::mul_round(a, b);
+}
+
+// truncating toward zero, so the magnitudes are divided and the sign is
+// applied afterwards. BigInt division rounds toward negative infinity.
+template <int N, int F>
+BigFixed<N, F> operator / (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    typedef BigInt<2 * N> double_type;
+    double_type a_mag = a.v.get_sign() ? double_type(a.v) : double_type(0) - a.v;
+    double_type b_mag = b.v.get_sign() ? double_type(b.v) : double_type(0) - b.v;
+    double_type q = (a_mag << F) / b_mag;
+    return BigFixed<N, F>::from_raw(BigInt<N>(a.v.get_sign() == b.v.get_sign() ? q : double_type(0) - q));
+}
+
+template <int N, int F>
+bool operator == (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return a.v == b.v;
+}
+
+template <int N, int F>
+bool operator != (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return a.v != b.v;
+}
+
+template <int N, int F>
+bool operator < (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return a.v < b.v;
+}
+
+template <int N, int F>
+bool operator > (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return a.v > b.v;
+}
+
+template <int N, int F>
+bool operator <= (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return a.v <= b.v;
+}
+
+template <int N, int F>
+bool operator >= (const BigFixed<N, F>& a, const BigFixed<N, F>& b) {
+    return a.v >= b.v;
+}
+
+}
+
+}
+
+#endif //BIGINT_FIXED_HPP
@@ -0,0 +1,125 @@
+#ifndef BIGINT_FIXED_BASE_POW_HPP
+#define BIGINT_FIXED_BASE_POW_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "forward_declare.hpp"
+#include "bigint.hpp"
+
+namespace hqythu {
+
+namespace bigint {
+
+// g^e mod p for a fixed g and p using a Lim-Lee comb.
+// the exponent is cut into `teeth` rows of span = ceil(max_bits / teeth)
+// bits, and the table holds every product of g^(2^(j * span)) over subsets of
+// rows. one exponentiation then costs span squarings and at most span
+// multiplications; more teeth means fewer squarings but 2^teeth table entries.
+// entries are stored at cache line aligned strides.
+template <int N>
+class FixedBasePow {
+private:
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef typename BigInt<N>::double_limb_type double_limb_type;
+    static const int cache_line = 64;
+
+    BigInt<N> g;
+    BigInt<N> p;
+    int max_bits;
+    int teeth;
+    int span;
+    int stride;
+    std::vector<limb_type> storage;
+    limb_type* table;
+    std::vector<int> table_len;
+
+    limb_type* entry(int i) const { return table + i * stride; }
+
+    void mul_entry(BigInt<N>& r, int i) const;
+
+public:
+    FixedBasePow(const BigInt<N>& g, const BigInt<N>& p, int max_bits, int teeth = 4);
+
+    FixedBasePow(const FixedBasePow&) = delete;
+    FixedBasePow& operator = (const FixedBasePow&) = delete;
+
+    int get_max_bits() const { return max_bits; }
+    int get_teeth() const { return teeth; }
+
+    BigInt<N> pow(const BigInt<N>& e) const;
+};
+
+template <int N>
+FixedBasePow<N>::FixedBasePow(const BigInt<N>& g, const BigInt<N>& p, int max_bits, int teeth)
+        : g(g % p), p(p), max_bits(max_bits), teeth(teeth) {
+    assert(teeth > 0 && max_bits > 0);
+    span = (max_bits + teeth - 1) / teeth;
+
+    const int limbs_per_line = cache_line / sizeof(limb_type);
+    stride = (BigInt<N>::N_limbs + limbs_per_line - 1) / limbs_per_line * limbs_per_line;
+    const int entries = 1 << teeth;
+    storage.assign(entries * stride + limbs_per_line, 0);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(storage.data());
+    table = storage.data() + (cache_line - addr % cache_line) % cache_line / sizeof(limb_type);
+    table_len.assign(entries, 1);
+
+    // row j holds g^(2^(j * span)).
+    std::vector<BigInt<N>> rows(teeth);
+    rows[0] = this->g;
+    for (int j = 1; j < teeth; j++) {
+        rows[j] = rows[j - 1];
+        for (int k = 0; k < span; k++) {
+            rows[j] = (rows[j] * rows[j]) % p;
+        }
+    }
+
+    entry(0)[0] = 1;
+    for (int i = 1; i < entries; i++) {
+        int top = 0;
+        while ((i >> (top + 1)) != 0) {
+            top++;
+        }
+        BigInt<N> v = rows[top];
+        mul_entry(v, i ^ (1 << top));
+        std::copy(v.data, v.data + v.len, entry(i));
+        table_len[i] = v.len;
+    }
+}
+
+template <int N>
+void FixedBasePow<N>::mul_entry(BigInt<N>& r, int i) const {
+    BigInt<N> prod, q;
+    prod.len = raw_mul_auto<limb_type, double_limb_type>(r.data, r.len, entry(i), table_len[i], prod.data, BigInt<N>::N_limbs);
+    BigInt<N>::div(prod, p, q, r);
+}
+
+template <int N>
+BigInt<N> FixedBasePow<N>::pow(const BigInt<N>& e) const {
+    if (e.get_bit_length() > max_bits) {
+        return hqythu::bigint::pow(g, e, p);
+    }
+    BigInt<N> r(1);
+    bool started = false;
+    for (int k = span - 1; k >= 0; k--) {
+        if (started) {
+            r = (r * r) % p;
+        }
+        int idx = 0;
+        for (int j = teeth - 1; j >= 0; j--) {
+            idx = (idx << 1) | e.get_bit(j * span + k);
+        }
+        if (idx) {
+            mul_entry(r, idx);
+            started = true;
+        }
+    }
+    return r % p;
+}
+
+}
+
+}
+
+#endif //BIGINT_FIXED_BASE_POW_HPP
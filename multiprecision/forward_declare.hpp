@@ -12,6 +12,24 @@ namespace bigint {
 template <int N>
 class BigInt;
 
+template <int N>
+struct BigIntConstant;
+
+template <int N>
+class FixedBasePow;
+
+template <int N, class Modulus>
+class ModInt;
+
+template <int N>
+class BigIntAccumulator;
+
+template <int N, int F>
+class BigFixed;
+
+template <int N>
+class ModExpEngine;
+
 }
 
 }
@@ -0,0 +1,100 @@
+#ifndef BIGINT_LITERAL_HPP
+#define BIGINT_LITERAL_HPP
+
+#include <cstdint>
+
+#include "forward_declare.hpp"
+
+namespace {
+
+constexpr int hex_digit_value(char c) {
+    return (c >= '0' && c <= '9') ? c - '0' :
+           (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+           (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+}
+
+template <int... Is>
+struct index_list {};
+
+template <int N, int... Is>
+struct make_index_list : make_index_list<N - 1, N - 1, Is...> {};
+
+template <int... Is>
+struct make_index_list<0, Is...> {
+    typedef index_list<Is...> type;
+};
+
+// the characters of a 0x... literal, split into 32 bit limbs.
+template <char... Cs>
+struct HexLiteral {
+    static const int length = sizeof...(Cs);
+    static const int digits = length - 2;
+    static const int bits = (digits * 4 + 31) / 32 * 32;
+    static constexpr char str[length] = {Cs...};
+
+    // digits in [begin, end), split in halves so the recursion depth is
+    // logarithmic in the literal length.
+    static constexpr bool valid_digits(int begin, int end) {
+        return end - begin <= 1 ? (begin >= end || hex_digit_value(str[begin]) >= 0) :
+               valid_digits(begin, (begin + end) / 2) && valid_digits((begin + end) / 2, end);
+    }
+
+    static constexpr bool valid() {
+        return length > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X') && valid_digits(2, length);
+    }
+
+    // k-th hex digit counted from the least significant one.
+    static constexpr uint32_t digit(int k) {
+        return k < digits ? static_cast<uint32_t>(hex_digit_value(str[length - 1 - k])) : 0;
+    }
+
+    static constexpr uint32_t limb(int i, int j = 0) {
+        return j == 8 ? 0 : (digit(8 * i + j) << (4 * j)) | limb(i, j + 1);
+    }
+};
+
+template <char... Cs>
+constexpr char HexLiteral<Cs...>::str[HexLiteral<Cs...>::length];
+
+}
+
+namespace hqythu {
+
+namespace bigint {
+
+// a BigInt value as a literal type. it lives in read-only data when declared
+// constexpr, converts to BigInt<M> by copying limbs, and limb(i) is a
+// constant expression, e.g. for writing ModInt modulus policies.
+template <int N>
+struct BigIntConstant {
+    static_assert(N % 32 == 0, "Bit length N_bits must be multiple of machine word (uint32_t)");
+    static const int N_limbs = N / 32;
+
+    uint32_t limbs[N / 32];
+
+    constexpr uint32_t limb(int i) const {
+        return i < N_limbs ? limbs[i] : 0;
+    }
+};
+
+template <char... Cs, int... Is>
+constexpr BigIntConstant<HexLiteral<Cs...>::bits> make_constant(index_list<Is...>) {
+    return BigIntConstant<HexLiteral<Cs...>::bits>{{HexLiteral<Cs...>::limb(Is)...}};
+}
+
+namespace literals {
+
+// 0x1234..._big, parsed at compile time. only hexadecimal is supported.
+template <char... Cs>
+constexpr BigIntConstant<HexLiteral<Cs...>::bits> operator "" _big() {
+    static_assert(HexLiteral<Cs...>::valid(), "_big literals must be hexadecimal (0x...)");
+    return make_constant<Cs...>(typename make_index_list<HexLiteral<Cs...>::bits / 32>::type());
+}
+
+}
+
+}
+
+}
+
+#endif //BIGINT_LITERAL_HPP
@@ -0,0 +1,297 @@
+#ifndef BIGINT_MODEXP_ENGINE_HPP
+#define BIGINT_MODEXP_ENGINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "forward_declare.hpp"
+#include "bigint.hpp"
+
+namespace hqythu {
+
+namespace bigint {
+
+// asynchronous a^d mod n service. jobs go into a bounded queue and complete
+// through a future or a callback on one of the worker threads.
+// an idle worker takes the oldest job together with every queued job on the
+// same modulus (up to max_batch_size) and runs the batch against a single
+// BarrettReducer. it waits for the batch to fill for at most
+// max_batch_latency after the oldest job was submitted.
+// the modulus must be positive, submit and try_submit throw
+// std::invalid_argument otherwise. a job that fails later, e.g. on
+// std::bad_alloc, completes with the exception: its future rethrows it, its
+// callback gets it with a zero result. callbacks run on worker threads and
+// must not throw.
+template <int N>
+class ModExpEngine {
+public:
+    // the result, or zero and the exception the job failed with.
+    typedef std::function<void(const BigInt<N>&, std::exception_ptr)> callback_type;
+    typedef std::chrono::steady_clock clock;
+
+    struct Config {
+        int threads;
+        size_t max_queue;
+        size_t max_batch_size;
+        std::chrono::microseconds max_batch_latency;
+
+        Config() : threads(std::max(1u, std::thread::hardware_concurrency())), max_queue(1024),
+                   max_batch_size(64), max_batch_latency(200) {}
+    };
+
+    // latency is from submission to completion, in microseconds.
+    struct Metrics {
+        size_t queue_depth;
+        size_t max_queue_depth;
+        uint64_t submitted;
+        uint64_t rejected;
+        uint64_t completed;
+        uint64_t batches;
+        double mean_latency_us;
+        double max_latency_us;
+    };
+
+private:
+    struct Job {
+        BigInt<N> a, d, n;
+        std::promise<BigInt<N>> promise;
+        callback_type callback;
+        clock::time_point submitted;
+    };
+
+    const Config config;
+    std::deque<Job> queue;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    bool stopping;
+    std::vector<std::thread> workers;
+
+    size_t max_queue_depth;
+    std::atomic<uint64_t> n_submitted;
+    std::atomic<uint64_t> n_rejected;
+    std::atomic<uint64_t> n_completed;
+    std::atomic<uint64_t> n_batches;
+    std::atomic<uint64_t> latency_sum_ns;
+    std::atomic<uint64_t> latency_max_ns;
+
+    static void check_modulus(const BigInt<N>& n);
+    void push(Job&& job);
+    bool take_batch(std::vector<Job>& batch);
+    void run_batch(std::vector<Job>& batch);
+    void finish(Job& job, const BigInt<N>& r, std::exception_ptr error);
+    void worker_loop();
+
+public:
+    explicit ModExpEngine(const Config& config = Config());
+    // completes every job still queued, then joins the workers.
+    ~ModExpEngine();
+
+    ModExpEngine(const ModExpEngine&) = delete;
+    ModExpEngine& operator = (const ModExpEngine&) = delete;
+
+    // block while the queue is full.
+    std::future<BigInt<N>> submit(const BigInt<N>& a, const BigInt<N>& d, const BigInt<N>& n);
+    void submit(const BigInt<N>& a, const BigInt<N>& d, const BigInt<N>& n, callback_type done);
+    // returns false instead of blocking when the queue is full.
+    bool try_submit(const BigInt<N>& a, const BigInt<N>& d, const BigInt<N>& n, callback_type done);
+
+    Metrics metrics() const;
+};
+
+template <int N>
+ModExpEngine<N>::ModExpEngine(const Config& config)
+        : config(config), stopping(false), max_queue_depth(0), n_submitted(0), n_rejected(0), n_completed(0),
+          n_batches(0), latency_sum_ns(0), latency_max_ns(0) {
+    assert(config.threads > 0 && config.max_queue > 0 && config.max_batch_size > 0);
+    for (int i = 0; i < config.threads; i++) {
+        workers.emplace_back(&ModExpEngine::worker_loop, this);
+    }
+}
+
+template <int N>
+ModExpEngine<N>::~ModExpEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    not_empty.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+template <int N>
+void ModExpEngine<N>::check_modulus(const BigInt<N>& n) {
+    if (!(n > 0u)) {
+        throw std::invalid_argument("ModExpEngine: the modulus must be positive");
+    }
+}
+
+template <int N>
+void ModExpEngine<N>::push(Job&& job) {
+    job.submitted = clock::now();
+    queue.push_back(std::move(job));
+    max_queue_depth = std::max(max_queue_depth, queue.size());
+    n_submitted++;
+}
+
+template <int N>
+std::future<BigInt<N>> ModExpEngine<N>::submit(const BigInt<N>& a, const BigInt<N>& d, const BigInt<N>& n) {
+    check_modulus(n);
+    Job job{a, d, n, std::promise<BigInt<N>>(), callback_type(), clock::time_point()};
+    std::future<BigInt<N>> result = job.promise.get_future();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return queue.size() < config.max_queue; });
+        push(std::move(job));
+    }
+    not_empty.notify_one();
+    return result;
+}
+
+template <int N>
+void ModExpEngine<N>::submit(const BigInt<N>& a, const BigInt<N>& d, const BigInt<N>& n, callback_type done) {
+    check_modulus(n);
+    Job job{a, d, n, std::promise<BigInt<N>>(), std::move(done), clock::time_point()};
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return queue.size() < config.max_queue; });
+        push(std::move(job));
+    }
+    not_empty.notify_one();
+}
+
+template <int N>
+bool ModExpEngine<N>::try_submit(const BigInt<N>& a, const BigInt<N>& d, const BigInt<N>& n, callback_type done) {
+    check_modulus(n);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= config.max_queue) {
+            n_rejected++;
+            return false;
+        }
+        push(Job{a, d, n, std::promise<BigInt<N>>(), std::move(done), clock::time_point()});
+    }
+    not_empty.notify_one();
+    return true;
+}
+
+// waits for a batch to be due: the oldest job has waited max_batch_latency,
+// or enough jobs share its modulus to fill a batch. false once stopping
+// with an empty queue.
+template <int N>
+bool ModExpEngine<N>::take_batch(std::vector<Job>& batch) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (queue.empty()) {
+            if (stopping) {
+                return false;
+            }
+            not_empty.wait(lock);
+            continue;
+        }
+        const BigInt<N>& n = queue.front().n;
+        size_t group = std::count_if(queue.begin(), queue.end(), [&n](const Job& job) { return job.n == n; });
+        clock::time_point due = queue.front().submitted + config.max_batch_latency;
+        if (stopping || group >= config.max_batch_size || clock::now() >= due) {
+            break;
+        }
+        not_empty.wait_until(lock, due);
+    }
+
+    BigInt<N> n = queue.front().n;
+    for (auto it = queue.begin(); it != queue.end() && batch.size() < config.max_batch_size;) {
+        if (it->n == n) {
+            batch.push_back(std::move(*it));
+            it = queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    lock.unlock();
+    not_full.notify_all();
+    // another worker can start on the next modulus right away.
+    not_empty.notify_one();
+    return true;
+}
+
+template <int N>
+void ModExpEngine<N>::finish(Job& job, const BigInt<N>& r, std::exception_ptr error) {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - job.submitted).count();
+    latency_sum_ns += ns;
+    uint64_t max = latency_max_ns;
+    while (ns > max && !latency_max_ns.compare_exchange_weak(max, ns)) {}
+    n_completed++;
+    if (job.callback) {
+        job.callback(r, error);
+    } else if (error) {
+        job.promise.set_exception(error);
+    } else {
+        job.promise.set_value(r);
+    }
+}
+
+// jobs before `done` have their result, the rest fail with the exception.
+template <int N>
+void ModExpEngine<N>::run_batch(std::vector<Job>& batch) {
+    n_batches++;
+    size_t done = 0;
+    try {
+        BarrettReducer<N> reducer(batch.front().n);
+        while (done < batch.size()) {
+            Job& job = batch[done];
+            BigInt<N> r = pow(job.a, job.d, reducer);
+            done++;
+            finish(job, r, std::exception_ptr());
+        }
+    } catch (...) {
+        std::exception_ptr error = std::current_exception();
+        while (done < batch.size()) {
+            finish(batch[done++], BigInt<N>(0), error);
+        }
+    }
+}
+
+template <int N>
+void ModExpEngine<N>::worker_loop() {
+    std::vector<Job> batch;
+    while (take_batch(batch)) {
+        run_batch(batch);
+        batch.clear();
+    }
+}
+
+template <int N>
+typename ModExpEngine<N>::Metrics ModExpEngine<N>::metrics() const {
+    Metrics m;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        m.queue_depth = queue.size();
+        m.max_queue_depth = max_queue_depth;
+    }
+    m.submitted = n_submitted;
+    m.rejected = n_rejected;
+    m.completed = n_completed;
+    m.batches = n_batches;
+    m.mean_latency_us = m.completed ? latency_sum_ns / 1000.0 / m.completed : 0.0;
+    m.max_latency_us = latency_max_ns / 1000.0;
+    return m;
+}
+
+}
+
+}
+
+#endif //BIGINT_MODEXP_ENGINE_HPP
@@ -0,0 +1,387 @@
+#ifndef BIGINT_MODINT_HPP
+#define BIGINT_MODINT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#include "forward_declare.hpp"
+#include "bigint.hpp"
+#include "literal.hpp"
+
+namespace hqythu {
+
+namespace bigint {
+
+constexpr uint32_t limb_at(int) {
+    return 0;
+}
+
+// the i-th of a list of limbs, for writing constexpr moduli.
+template <class... Limbs>
+constexpr uint32_t limb_at(int i, uint32_t first, Limbs... rest) {
+    return i == 0 ? first : limb_at(i - 1, rest...);
+}
+
+// a modulus is described by a policy type with
+//   bits, limbs, limb(i)     the value, least significant limb first
+//   special                  whether 2^(32 * limbs) mod m is small
+//   fold_limbs, fold_limb(i) C = 2^(32 * limbs) mod m, when special
+// generic moduli must be odd and are reduced with Montgomery multiplication,
+// special ones by folding the limbs above 2^(32 * limbs) back in as hi * C.
+struct GenericModulus {
+    static constexpr bool special = false;
+    static constexpr int fold_limbs = 0;
+    static constexpr uint32_t fold_limb(int) { return 0; }
+};
+
+// 2^255 - 19, 2^256 = 38
+struct Curve25519Prime {
+    static constexpr int bits = 255;
+    static constexpr int limbs = 8;
+    static constexpr uint32_t limb(int i) {
+        return limb_at(i, 0xffffffed, 0xffffffff, 0xffffffff, 0xffffffff,
+                       0xffffffff, 0xffffffff, 0xffffffff, 0x7fffffff);
+    }
+    static constexpr bool special = true;
+    static constexpr int fold_limbs = 1;
+    static constexpr uint32_t fold_limb(int) { return 38; }
+};
+
+// 2^256 - 2^224 + 2^192 + 2^96 - 1.
+// 2^256 mod p has 224 bits, so folding only removes a limb per round.
+// its Montgomery constant is 1, which makes the generic path the faster one.
+struct P256Prime : GenericModulus {
+    static constexpr int bits = 256;
+    static constexpr int limbs = 8;
+    static constexpr uint32_t limb(int i) {
+        return limb_at(i, 0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+                       0x00000000, 0x00000000, 0x00000001, 0xffffffff);
+    }
+};
+
+// 2^256 - 2^32 - 977, 2^256 = 2^32 + 977
+struct Secp256k1Prime {
+    static constexpr int bits = 256;
+    static constexpr int limbs = 8;
+    static constexpr uint32_t limb(int i) {
+        return limb_at(i, 0xfffffc2f, 0xfffffffe, 0xffffffff, 0xffffffff,
+                       0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff);
+    }
+    static constexpr bool special = true;
+    static constexpr int fold_limbs = 2;
+    static constexpr uint32_t fold_limb(int i) { return limb_at(i, 0x3d1, 1); }
+};
+
+// 2^127 - 1, 2^128 = 2
+struct Mersenne127Prime {
+    static constexpr int bits = 127;
+    static constexpr int limbs = 4;
+    static constexpr uint32_t limb(int i) {
+        return limb_at(i, 0xffffffff, 0xffffffff, 0xffffffff, 0x7fffffff);
+    }
+    static constexpr bool special = true;
+    static constexpr int fold_limbs = 1;
+    static constexpr uint32_t fold_limb(int) { return 2; }
+};
+
+// R^2 mod m with R = 2^(32 * limbs) as a constant expression, by doubling
+// 1 modulo m 2 * 32 * limbs times. the limbs of m are read once into m, the
+// comparison with m is made once per doubling and 2x - m carries its borrow
+// from limb to limb, so a doubling is linear in the limbs. the doublings are
+// nested in halves, so the constexpr recursion stays shallow.
+template <class Modulus>
+struct MontgomeryConstants {
+    static const int n = Modulus::limbs;
+    typedef BigIntConstant<32 * Modulus::limbs> value_type;
+
+    template <int... Is>
+    static constexpr value_type read_modulus(index_list<Is...>) {
+        return value_type{{Modulus::limb(Is)...}};
+    }
+    static constexpr value_type m = read_modulus(typename make_index_list<n>::type());
+
+    // limb i of 2x.
+    static constexpr uint32_t shl1(const value_type& x, int i) {
+        return (x.limb(i) << 1) | (i > 0 ? x.limb(i - 1) >> 31 : 0);
+    }
+    // 2x >= m, comparing the limbs from i down.
+    static constexpr bool ge(const value_type& x, int i) {
+        return i < 0 ? true : shl1(x, i) != m.limb(i) ? shl1(x, i) > m.limb(i) : ge(x, i - 1);
+    }
+    static constexpr uint32_t sub_borrow(uint32_t x, uint32_t y, uint32_t borrow) {
+        return (x < y || (x == y && borrow)) ? 1 : 0;
+    }
+    // 2x - m, the limbs below sizeof...(Limbs) are done.
+    template <class... Limbs>
+    static constexpr typename std::enable_if<sizeof...(Limbs) == n, value_type>::type
+    sub_m(const value_type&, uint32_t, Limbs... done) {
+        return value_type{{done...}};
+    }
+    template <class... Limbs>
+    static constexpr typename std::enable_if<(sizeof...(Limbs) < n), value_type>::type
+    sub_m(const value_type& x, uint32_t borrow, Limbs... done) {
+        return sub_m(x, sub_borrow(shl1(x, sizeof...(Limbs)), m.limb(sizeof...(Limbs)), borrow),
+                     done..., shl1(x, sizeof...(Limbs)) - m.limb(sizeof...(Limbs)) - borrow);
+    }
+    template <int... Is>
+    static constexpr value_type double_mod(const value_type& x, index_list<Is...>) {
+        return (x.limb(n - 1) >> 31) || ge(x, n - 1) ? sub_m(x, 0) : value_type{{shl1(x, Is)...}};
+    }
+    static constexpr value_type double_times(const value_type& x, int count) {
+        return count == 0 ? x :
+               count == 1 ? double_mod(x, typename make_index_list<n>::type()) :
+               double_times(double_times(x, count / 2), count - count / 2);
+    }
+    static constexpr value_type one() {
+        return value_type{{1}};
+    }
+
+    static constexpr value_type r2 = double_times(one(), 2 * 32 * n);
+};
+
+template <class Modulus>
+constexpr typename MontgomeryConstants<Modulus>::value_type MontgomeryConstants<Modulus>::m;
+template <class Modulus>
+constexpr typename MontgomeryConstants<Modulus>::value_type MontgomeryConstants<Modulus>::r2;
+
+// residue modulo the compile-time constant Modulus, stored in the limbs of a
+// BigInt<N>. N only needs to hold the modulus, products are formed in double
+// width buffers on the stack.
+template <int N, class Modulus>
+class ModInt {
+    static_assert(Modulus::bits <= N, "BigInt<N> must be wide enough to hold the modulus");
+private:
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef typename BigInt<N>::double_limb_type double_limb_type;
+    static const int limb_bits = BigInt<N>::limb_bits;
+    static const int n_limbs = Modulus::limbs;
+    static const int wide_len = 2 * Modulus::limbs + 2;
+
+    // -m^-1 mod 2^32 by Newton iteration, each step doubles the correct bits.
+    static constexpr limb_type mont_inv_step(limb_type inv, int steps) {
+        return steps == 0 ? inv : mont_inv_step(inv * (2 - Modulus::limb(0) * inv), steps - 1);
+    }
+    static constexpr limb_type mont_n0() {
+        return 0u - mont_inv_step(Modulus::limb(0), 4);
+    }
+
+    BigInt<N> v;
+
+    static void assign(BigInt<N>& r, const limb_type* t, int t_len);
+    static int fold_reduce(limb_type* t, int t_len);
+    static int mont_reduce(limb_type* t, int t_len);
+    static void reduce_wide(limb_type* t, int t_len, BigInt<N>& result);
+
+public:
+    ModInt() {}
+    ModInt(int x) : ModInt(BigInt<N>(x)) {}
+    explicit ModInt(const BigInt<N>& x);
+
+    static const BigInt<N>& modulus();
+
+    BigInt<N> value() const;
+
+    ModInt sqr() const { return *this * *this; }
+    ModInt inv() const;
+    ModInt pow(const BigInt<N>& e) const;
+
+    template <int M, class Mod>
+    friend ModInt<M, Mod> operator + (const ModInt<M, Mod>& a, const ModInt<M, Mod>& b);
+    template <int M, class Mod>
+    friend ModInt<M, Mod> operator - (const ModInt<M, Mod>& a, const ModInt<M, Mod>& b);
+    template <int M, class Mod>
+    friend ModInt<M, Mod> operator * (const ModInt<M, Mod>& a, const ModInt<M, Mod>& b);
+    template <int M, class Mod>
+    friend bool operator == (const ModInt<M, Mod>& a, const ModInt<M, Mod>& b);
+    template <int M, class Mod>
+    friend bool operator != (const ModInt<M, Mod>& a, const ModInt<M, Mod>& b);
+};
+
+template <int N, class Modulus>
+const int ModInt<N, Modulus>::limb_bits;
+template <int N, class Modulus>
+const int ModInt<N, Modulus>::n_limbs;
+template <int N, class Modulus>
+const int ModInt<N, Modulus>::wide_len;
+
+template <int N, class Modulus>
+const BigInt<N>& ModInt<N, Modulus>::modulus() {
+    static const BigInt<N> m = []() {
+        BigInt<N> r;
+        limb_type t[n_limbs];
+        for (int i = 0; i < n_limbs; i++) {
+            t[i] = Modulus::limb(i);
+        }
+        assign(r, t, n_limbs);
+        return r;
+    }();
+    return m;
+}
+
+template <int N, class Modulus>
+void ModInt<N, Modulus>::assign(BigInt<N>& r, const limb_type* t, int t_len) {
+    r.len = normalize(t, t_len);
+    assert(r.len <= BigInt<N>::N_limbs);
+    std::copy(t, t + r.len, r.data);
+    r.positive = true;
+}
+
+// t = hi * 2^(32 n) + lo == lo + hi * C (mod m), repeated until t has n
+// limbs. with C of one or two limbs this takes two or three rounds.
+template <int N, class Modulus>
+int ModInt<N, Modulus>::fold_reduce(limb_type* t, int t_len) {
+    limb_type hi[wide_len];
+    t_len = normalize(t, t_len);
+    while (t_len > n_limbs) {
+        int hi_len = t_len - n_limbs;
+        std::copy(t + n_limbs, t + t_len, hi);
+        std::fill(t + n_limbs, t + wide_len, 0);
+        for (int j = 0; j < Modulus::fold_limbs; j++) {
+            double_limb_type carry = raw_addmul_1<limb_type, double_limb_type>(t + j, hi, hi_len, Modulus::fold_limb(j));
+            for (int i = j + hi_len; carry; i++) {
+                carry += t[i];
+                t[i] = static_cast<limb_type>(carry);
+                carry >>= limb_bits;
+            }
+        }
+        t_len = normalize(t, std::max(n_limbs, hi_len + Modulus::fold_limbs + 1));
+    }
+    return t_len;
+}
+
+// Montgomery reduction, t * R^-1 mod m for t < m * R. the result is left at t.
+template <int N, class Modulus>
+int ModInt<N, Modulus>::mont_reduce(limb_type* t, int t_len) {
+    const BigInt<N>& m = modulus();
+    std::fill(t + t_len, t + wide_len, 0);
+    for (int i = 0; i < n_limbs; i++) {
+        limb_type u = t[i] * mont_n0();
+        double_limb_type carry = raw_addmul_1<limb_type, double_limb_type>(t + i, m.data, n_limbs, u);
+        for (int j = i + n_limbs; carry && j < wide_len; j++) {
+            carry += t[j];
+            t[j] = static_cast<limb_type>(carry);
+            carry >>= limb_bits;
+        }
+    }
+    std::copy(t + n_limbs, t + wide_len, t);
+    return normalize(t, wide_len - n_limbs);
+}
+
+template <int N, class Modulus>
+void ModInt<N, Modulus>::reduce_wide(limb_type* t, int t_len, BigInt<N>& result) {
+    const BigInt<N>& m = modulus();
+    if (Modulus::special) {
+        t_len = fold_reduce(t, t_len);
+    } else {
+        t_len = mont_reduce(t, t_len);
+    }
+    while (compare_unsigned(t, t_len, m.data, m.len) >= 0) {
+        t_len = raw_sub<limb_type, double_limb_type>(t, t_len, m.data, m.len, t, wide_len);
+    }
+    assign(result, t, t_len);
+}
+
+template <int N, class Modulus>
+ModInt<N, Modulus>::ModInt(const BigInt<N>& x) {
+    v = x % modulus();
+    if (!Modulus::special) {
+        limb_type t[wide_len];
+        const limb_type* r2 = MontgomeryConstants<Modulus>::r2.limbs;
+        int t_len = raw_mul<limb_type, double_limb_type>(v.data, v.len, r2, normalize(r2, n_limbs), t, wide_len);
+        reduce_wide(t, t_len, v);
+    }
+}
+
+template <int N, class Modulus>
+BigInt<N> ModInt<N, Modulus>::value() const {
+    if (Modulus::special) {
+        return v;
+    }
+    limb_type t[wide_len];
+    std::copy(v.data, v.data + v.len, t);
+    BigInt<N> result;
+    reduce_wide(t, v.len, result);
+    return result;
+}
+
+// Fermat inversion, the modulus must be prime.
+template <int N, class Modulus>
+ModInt<N, Modulus> ModInt<N, Modulus>::inv() const {
+    return pow(modulus() - BigInt<N>(2));
+}
+
+template <int N, class Modulus>
+ModInt<N, Modulus> ModInt<N, Modulus>::pow(const BigInt<N>& e) const {
+    ModInt r(1);
+    for (int i = e.get_bit_length() - 1; i >= 0; i--) {
+        r = r.sqr();
+        if (e.get_bit(i)) {
+            r = r * *this;
+        }
+    }
+    return r;
+}
+
+template <int N, class Modulus>
+ModInt<N, Modulus> operator + (const ModInt<N, Modulus>& a, const ModInt<N, Modulus>& b) {
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef typename BigInt<N>::double_limb_type double_limb_type;
+    const int t_max = Modulus::limbs + 1;
+    const BigInt<N>& m = ModInt<N, Modulus>::modulus();
+    limb_type t[t_max];
+    int t_len = raw_add<limb_type, double_limb_type>(a.v.get_data(), a.v.get_len(), b.v.get_data(), b.v.get_len(), t, t_max);
+    if (compare_unsigned(t, t_len, m.get_data(), m.get_len()) >= 0) {
+        t_len = raw_sub<limb_type, double_limb_type>(t, t_len, m.get_data(), m.get_len(), t, t_max);
+    }
+    ModInt<N, Modulus> r;
+    ModInt<N, Modulus>::assign(r.v, t, t_len);
+    return r;
+}
+
+template <int N, class Modulus>
+ModInt<N, Modulus> operator - (const ModInt<N, Modulus>& a, const ModInt<N, Modulus>& b) {
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef typename BigInt<N>::double_limb_type double_limb_type;
+    const int t_max = Modulus::limbs + 1;
+    const BigInt<N>& m = ModInt<N, Modulus>::modulus();
+    limb_type t[t_max];
+    int t_len;
+    if (compare_unsigned(a.v.get_data(), a.v.get_len(), b.v.get_data(), b.v.get_len()) >= 0) {
+        t_len = raw_sub<limb_type, double_limb_type>(a.v.get_data(), a.v.get_len(), b.v.get_data(), b.v.get_len(), t, t_max);
+    } else {
+        t_len = raw_add<limb_type, double_limb_type>(a.v.get_data(), a.v.get_len(), m.get_data(), m.get_len(), t, t_max);
+        t_len = raw_sub<limb_type, double_limb_type>(t, t_len, b.v.get_data(), b.v.get_len(), t, t_max);
+    }
+    ModInt<N, Modulus> r;
+    ModInt<N, Modulus>::assign(r.v, t, t_len);
+    return r;
+}
+
+template <int N, class Modulus>
+ModInt<N, Modulus> operator * (const ModInt<N, Modulus>& a, const ModInt<N, Modulus>& b) {
+    typedef typename BigInt<N>::limb_type limb_type;
+    typedef typename BigInt<N>::double_limb_type double_limb_type;
+    limb_type t[ModInt<N, Modulus>::wide_len];
+    int t_len = raw_mul<limb_type, double_limb_type>(a.v.get_data(), a.v.get_len(), b.v.get_data(), b.v.get_len(), t, ModInt<N, Modulus>::wide_len);
+    ModInt<N, Modulus> r;
+    ModInt<N, Modulus>::reduce_wide(t, t_len, r.v);
+    return r;
+}
+
+template <int N, class Modulus>
+bool operator == (const ModInt<N, Modulus>& a, const ModInt<N, Modulus>& b) {
+    return a.v == b.v;
+}
+
+template <int N, class Modulus>
+bool operator != (const ModInt<N, Modulus>& a, const ModInt<N, Modulus>& b) {
+    return a.v != b.v;
+}
+
+}
+
+}
+
+#endif //BIGINT_MODINT_HPP
@@ -5,7 +5,10 @@
 #ifndef BIGINT_NUMBER_THEORY_HPP
 #define BIGINT_NUMBER_THEORY_HPP
 
+#include <cassert>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "forward_declare.hpp"
 #include "bigint.hpp"
@@ -16,7 +19,7 @@ namespace bigint {
 
 template <class T>
 T gcd(const T& a, const T& b) {
-    if (b == T(0)) {
+    if (b == 0u) {
         return a;
     } else {
         return gcd(b, a % b);
@@ -25,7 +28,7 @@ T gcd(const T& a, const T& b) {
 
 template <class T>
 std::tuple<T, T, T> ext_gcd(const T& a, const T& b) {
-    if (b == T(0)) {
+    if (b == 0u) {
         return std::make_tuple(T(1), T(0), a);
     } else {
         T x, y, q;
@@ -37,15 +40,15 @@ std::tuple<T, T, T> ext_gcd(const T& a, const T& b) {
 
 template <class T>
 bool miller_rabin_test(const T& p, const T& a) {
-    T p_ = p - T(1);
+    T p_ = p - 1u;
     T q = p_;
     int k = 0;
-    while (q % T(2) == T(0)) {
-        q = q / T(2);
+    while (q % 2u == 0u) {
+        q = q / 2u;
         k++;
     }
     T t = pow(a, q, p);
-    if (t == T(1)) {
+    if (t == 1u) {
         return true;
     }
     if (t == p_) {
@@ -63,17 +66,17 @@ bool miller_rabin_test(const T& p, const T& a) {
 
 template <class T>
 bool is_prime_miller_rabin(const T& p) {
-    if (p == T(2)) {
+    if (p == 2u) {
         return true;
     }
-    if (p % T(2) == T(0)) {
+    if (p % 2u == 0u) {
         return false;
     }
-    T p_ = p - T(1);
+    T p_ = p - 1u;
     int iter_time = 10;
     while (iter_time) {
         T a = T::random() % p_;
-        if (a == T(0)) {
+        if (a == 0u) {
             continue;
         }
         assert(a < p_);
@@ -86,6 +89,192 @@ bool is_prime_miller_rabin(const T& p) {
     return true;
 }
 
+// floor(sqrt(n)) by Newton iteration from 2^ceil(bits / 2), which is never
+// below the root, so the iterates decrease monotonically until they stop.
+template <class T>
+T isqrt(const T& n) {
+    assert(n.get_sign());
+    if (n == 0u) {
+        return T(0);
+    }
+    T x = T(1) << ((n.get_bit_length() + 1) / 2);
+    while (true) {
+        T y = (x + n / x) >> 1;
+        if (y >= x) {
+            return x;
+        }
+        x = y;
+    }
+}
+
+// (s, n - s^2) with s = floor(sqrt(n)).
+template <class T>
+std::pair<T, T> isqrt_rem(const T& n) {
+    T s = isqrt(n);
+    return std::make_pair(s, n - s * s);
+}
+
+// x^k, or n + 1 as soon as the power is known to exceed n. checks bit
+// lengths before multiplying so the product never needs more than one bit
+// over n.
+template <class T>
+T bounded_pow(const T& x, int k, const T& n) {
+    T r(1);
+    const int n_bits = n.get_bit_length();
+    for (int i = 0; i < k; i++) {
+        if (r.get_bit_length() + x.get_bit_length() - 2 >= n_bits) {
+            return n + 1u;
+        }
+        r = r * x;
+        if (r > n) {
+            return n + 1u;
+        }
+    }
+    return r;
+}
+
+// floor(n^(1/k)) by Newton iteration x' = ((k - 1) x + n / x^(k - 1)) / k.
+// T needs one bit above n.
+template <class T>
+T iroot(const T& n, int k) {
+    assert(n.get_sign() && k >= 1);
+    if (k == 1 || n <= 1u) {
+        return n;
+    }
+    if (k == 2) {
+        return isqrt(n);
+    }
+    const uint32_t k_ = static_cast<uint32_t>(k);
+    T x = T(1) << ((n.get_bit_length() + k - 1) / k);
+    while (true) {
+        T y = (x * (k_ - 1) + n / bounded_pow(x, k - 1, n)) / k_;
+        if (y >= x) {
+            return x;
+        }
+        x = y;
+    }
+}
+
+// whether r is a k-th power residue modulo the prime p, p = 1 (mod k).
+inline bool is_power_residue(uint32_t r, uint32_t k, uint32_t p) {
+    if (r == 0) {
+        return true;
+    }
+    uint64_t result = 1, base = r, e = (p - 1) / k;
+    while (e) {
+        if (e & 1) {
+            result = result * base % p;
+        }
+        base = base * base % p;
+        e >>= 1;
+    }
+    return result == 1;
+}
+
+// trial division, for the small filter primes of perfect_power.
+inline bool is_small_prime(uint32_t p) {
+    if (p < 2) {
+        return false;
+    }
+    for (uint32_t d = 2; d * d <= p; d++) {
+        if (p % d == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// (root, k) with n = root^k for the smallest prime k that works, or (n, 1)
+// if n is not a perfect power. each candidate exponent is first filtered by
+// k-th power residues modulo the first primes p = 2jk + 1 (p = 2j + 1 for
+// k = 2), so the root is only extracted for exponents that pass all of them.
+template <class T>
+std::pair<T, int> perfect_power(const T& n) {
+    assert(n.get_sign());
+    if (n <= 1u) {
+        return std::make_pair(n, 2);
+    }
+    const int max_filters = 8;
+    const int bits = n.get_bit_length();
+    std::vector<bool> composite(bits + 1, false);
+    for (int k = 2; k <= bits; k++) {
+        if (composite[k]) {
+            continue;
+        }
+        for (int j = 2 * k; j <= bits; j += k) {
+            composite[j] = true;
+        }
+        const uint32_t k_ = static_cast<uint32_t>(k);
+        const uint32_t step = k == 2 ? 2 : 2 * k_;
+        bool candidate = true;
+        int filters = 0;
+        for (uint32_t p = step + 1; filters < max_filters; p += step) {
+            if (!is_small_prime(p)) {
+                continue;
+            }
+            filters++;
+            if (!is_power_residue(n % p, k_, p)) {
+                candidate = false;
+                break;
+            }
+        }
+        if (!candidate) {
+            continue;
+        }
+        T root = iroot(n, k);
+        if (bounded_pow(root, k, n) == n) {
+            return std::make_pair(root, k);
+        }
+    }
+    return std::make_pair(n, 1);
+}
+
+template <class T>
+bool is_perfect_power(const T& n) {
+    return perfect_power(n).second > 1;
+}
+
+// precomputed CRT parameters for a^d mod p*q, all at half width. p and q may
+// use all N / 2 bits.
+template <int N>
+struct CRTParams {
+    BigInt<N / 2> p, q;
+    BigInt<N / 2> dp, dq;
+    BigInt<N / 2> q_inv;
+};
+
+template <int N>
+CRTParams<N> crt_params(const BigInt<N>& d, const BigInt<N / 2>& p, const BigInt<N / 2>& q) {
+    typedef BigInt<N / 2> half_type;
+    CRTParams<N> params;
+    params.p = p;
+    params.q = q;
+    params.dp = d % (p - 1u);
+    params.dq = d % (q - 1u);
+    half_type x, y, g;
+    std::tie(x, y, g) = ext_gcd(q, p);
+    assert(g == 1u);
+    if (!x.get_sign()) {
+        x = x + p;
+    }
+    params.q_inv = x % p;
+    return params;
+}
+
+// a^d mod p*q, exponentiating mod p and mod q at half width and recombining
+// with Garner's formula m = m_q + q * (q_inv * (m_p - m_q) mod p). the
+// half width exponentiations reduce through BarrettReducer, whose products
+// are wider than p^2, and q_inv * (m_p - m_q) is formed at full width.
+template <int N>
+BigInt<N> pow_crt(const BigInt<N>& a, const CRTParams<N>& params) {
+    typedef BigInt<N / 2> half_type;
+    half_type m_p = pow(half_type(a % params.p), params.dp, BarrettReducer<N / 2>(params.p));
+    half_type m_q = pow(half_type(a % params.q), params.dq, BarrettReducer<N / 2>(params.q));
+    half_type m_q_p = m_q % params.p;
+    half_type diff = (m_p >= m_q_p) ? m_p - m_q_p : params.p - (m_q_p - m_p);
+    BigInt<N> h = (BigInt<N>(params.q_inv) * BigInt<N>(diff)) % BigInt<N>(params.p);
+    return BigInt<N>(m_q) + h * BigInt<N>(params.q);
+}
 }
 
 }
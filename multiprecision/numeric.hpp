@@ -7,6 +7,8 @@
 
 #include <random>
 #include <chrono>
+#include <vector>
+#include <algorithm>
 
 namespace hqythu {
 
@@ -31,19 +33,135 @@ BigInt<N> BigInt<N>::random() {
 
 template <class T>
 T pow(T a, T d, T n) {
-    if (d == T(0)) {
+    if (d == 0u) {
         return T(1);
-    } else if (d == T(1)) {
+    } else if (d == 1u) {
         return a % n;
     }
-    T t = pow(a, d / T(2), n);
-    if (d % T(2) == T(0)) {
+    T t = pow(a, d / 2u, n);
+    if (d % 2u == 0u) {
         return (t * t) % n;
     } else {
         return (((t * t) % n) * a) % n;
     }
 }
 
+// Barrett reduction modulo a fixed n of k bits: mu = floor(4^k / n) is
+// computed once, then x mod n for 0 <= x < n^2 takes two multiplications
+// and at most two subtractions instead of a division.
+// mu and the products are kept in wide_type, so n may use all N bits.
+template <int N>
+class BarrettReducer {
+public:
+    // (x >> (k - 1)) * mu takes up to 2k + 2 bits.
+    typedef BigInt<2 * N + 64> wide_type;
+
+private:
+    wide_type n;
+    int k;
+    wide_type mu;
+
+public:
+    explicit BarrettReducer(const BigInt<N>& n) : n(n), k(n.get_bit_length()), mu(newton_reciprocal(this->n, 2 * k).first) {
+        assert(n > 0u);
+    }
+
+    BigInt<N> modulus() const { return BigInt<N>(n); }
+
+    BigInt<N> reduce(const wide_type& x) const {
+        wide_type q = ((x >> (k - 1)) * mu) >> (k + 1);
+        wide_type r = x - q * n;
+        while (r >= n) {
+            r = r - n;
+        }
+        return BigInt<N>(r);
+    }
+};
+
+// a^d mod n with the reduction precomputed, for many exponentiations
+// sharing one modulus.
+template <int N>
+BigInt<N> pow(const BigInt<N>& a, const BigInt<N>& d, const BarrettReducer<N>& n) {
+    typedef typename BarrettReducer<N>::wide_type wide_type;
+    wide_type a_ = a % n.modulus();
+    wide_type r(1);
+    for (int i = d.get_bit_length() - 1; i >= 0; i--) {
+        r = n.reduce(r * r);
+        if (d.get_bit(i)) {
+            r = n.reduce(r * a_);
+        }
+    }
+    return BigInt<N>(r);
+}
+
+// simultaneous multi-exponentiation (Straus): prod bases[i]^exps[i] mod n.
+// all bases share one chain of squarings, the exponents are scanned in
+// interleaved windows of `window` bits against per-base tables of
+// bases[i]^0 .. bases[i]^(2^window - 1).
+template <class T>
+T multi_pow(const std::vector<T>& bases, const std::vector<T>& exps, const T& n, int window = 4) {
+    assert(bases.size() == exps.size());
+    const int table_size = 1 << window;
+    int bits = 0;
+    for (const T& e : exps) {
+        bits = std::max(bits, e.get_bit_length());
+    }
+
+    std::vector<std::vector<T>> tables(bases.size());
+    for (size_t i = 0; i < bases.size(); i++) {
+        tables[i].reserve(table_size);
+        tables[i].push_back(T(1));
+        tables[i].push_back(bases[i] % n);
+        for (int j = 2; j < table_size; j++) {
+            tables[i].push_back((tables[i][j - 1] * tables[i][1]) % n);
+        }
+    }
+
+    T r(1);
+    bool started = false;
+    for (int pos = (bits + window - 1) / window * window - window; pos >= 0; pos -= window) {
+        if (started) {
+            for (int k = 0; k < window; k++) {
+                r = (r * r) % n;
+            }
+        }
+        for (size_t i = 0; i < exps.size(); i++) {
+            int digit = 0;
+            for (int k = window - 1; k >= 0; k--) {
+                digit = (digit << 1) | exps[i].get_bit(pos + k);
+            }
+            if (digit) {
+                r = (r * tables[i][digit]) % n;
+                started = true;
+            }
+        }
+    }
+    return r % n;
+}
+
+// a^x * b^y mod n by Shamir's trick: one squaring per exponent bit and at
+// most one multiplication by a, b or a*b.
+template <class T>
+T pow2(const T& a, const T& x, const T& b, const T& y, const T& n) {
+    T a_ = a % n;
+    T b_ = b % n;
+    T ab = (a_ * b_) % n;
+    int bits = std::max(x.get_bit_length(), y.get_bit_length());
+    T r(1);
+    for (int i = bits - 1; i >= 0; i--) {
+        r = (r * r) % n;
+        bool bx = x.get_bit(i), by = y.get_bit(i);
+        if (bx && by) {
+            r = (r * ab) % n;
+        } else if (bx) {
+            r = (r * a_) % n;
+        } else if (by) {
+            r = (r * b_) % n;
+        }
+    }
+    return r % n;
+}
+
 }
 
 }
@@ -0,0 +1,182 @@
+#ifndef BIGINT_PARALLEL_HPP
+#define BIGINT_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace hqythu {
+
+namespace bigint {
+
+// opt-in parallel execution of the multiplication kernels.
+// independent sub-products of operands with at least threshold_limbs limbs
+// run on a pool of `threads` persistent worker threads. results are
+// identical to the sequential path, only the order in which sub-products are
+// computed changes.
+// a task is only handed to the pool after reserving an idle worker for it,
+// so a caller waiting on a forked task never waits for a busy pool.
+class ParallelConfig {
+private:
+    std::atomic<int> threads;
+    std::atomic<int> threshold_limbs;
+    std::atomic<int> idle_workers;
+
+    std::mutex mutex;
+    std::condition_variable has_task;
+    // a list, unlike a deque, allocates nothing until the first task, so
+    // instance() keeps caller supplied workspaces free of heap allocations.
+    std::list<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    ParallelConfig() : threads(0), threshold_limbs(256), idle_workers(0), stopping(false) {}
+
+    ~ParallelConfig() {
+        stop_workers();
+    }
+
+    void worker_loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                has_task.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+            idle_workers++;
+        }
+    }
+
+    void stop_workers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        has_task.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        stopping = false;
+    }
+
+public:
+    static ParallelConfig& instance() {
+        static ParallelConfig config;
+        return config;
+    }
+
+    ParallelConfig(const ParallelConfig&) = delete;
+    ParallelConfig& operator = (const ParallelConfig&) = delete;
+
+    // threads == 0 disables parallel execution. resizing the pool waits for
+    // running tasks, it must not be called from inside one.
+    void set(int n_threads, int n_threshold_limbs) {
+        threshold_limbs = n_threshold_limbs;
+        if (n_threads == threads) {
+            return;
+        }
+        threads = 0;
+        stop_workers();
+        idle_workers = n_threads;
+        for (int i = 0; i < n_threads; i++) {
+            workers.emplace_back(&ParallelConfig::worker_loop, this);
+        }
+        threads = n_threads;
+    }
+
+    int get_threads() const { return threads; }
+    int get_threshold_limbs() const { return threshold_limbs; }
+
+    bool enabled_for(int a_len, int b_len) const {
+        return threads > 0 && std::min(a_len, b_len) >= threshold_limbs;
+    }
+
+    bool try_acquire_worker() {
+        int n = idle_workers;
+        while (n > 0) {
+            if (idle_workers.compare_exchange_weak(n, n - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // runs task on the pool, after try_acquire_worker() succeeded.
+    void run(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        has_task.notify_one();
+    }
+};
+
+inline void set_parallel(int threads, int threshold_limbs = 256) {
+    ParallelConfig::instance().set(threads, threshold_limbs);
+}
+
+// runs f on a pool worker if one is idle, otherwise on the calling thread
+// when the returned future is waited on.
+template <class F>
+std::future<decltype(std::declval<F&>()())> fork_task(F f) {
+    typedef decltype(std::declval<F&>()()) result_type;
+    ParallelConfig& config = ParallelConfig::instance();
+    if (config.try_acquire_worker()) {
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::move(f));
+        std::future<result_type> result = task->get_future();
+        config.run([task]() { (*task)(); });
+        return result;
+    }
+    return std::async(std::launch::deferred, std::move(f));
+}
+
+// calls f(i) for every i in [0, n), splitting the range into contiguous
+// chunks across idle workers when parallel execution is enabled.
+template <class F>
+void parallel_for(int n, F f) {
+    int chunks = std::min(n, ParallelConfig::instance().get_threads() + 1);
+    if (chunks <= 1) {
+        for (int i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+    std::vector<std::future<int>> tasks;
+    for (int c = 1; c < chunks; c++) {
+        int begin = static_cast<long long>(n) * c / chunks;
+        int end = static_cast<long long>(n) * (c + 1) / chunks;
+        tasks.push_back(fork_task([=]() {
+            for (int i = begin; i < end; i++) {
+                f(i);
+            }
+            return 0;
+        }));
+    }
+    for (int i = 0; i < n / chunks; i++) {
+        f(i);
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+}
+
+}
+
+}
+
+#endif //BIGINT_PARALLEL_HPP
@@ -0,0 +1,83 @@
+#ifndef BIGINT_PRODUCT_TREE_HPP
+#define BIGINT_PRODUCT_TREE_HPP
+
+#include <vector>
+
+#include "forward_declare.hpp"
+#include "bigint.hpp"
+#include "parallel.hpp"
+
+namespace hqythu {
+
+namespace bigint {
+
+// levels of the product tree, level 0 holds the leaves and the last level the
+// product of all of them. an unpaired node is carried up unchanged. no
+// leaves give a single empty level.
+// T must be wide enough to hold the root (and its square for batch_gcd).
+template <class T>
+std::vector<std::vector<T>> product_tree(const std::vector<T>& leaves) {
+    std::vector<std::vector<T>> tree(1, leaves);
+    while (tree.back().size() > 1) {
+        const std::vector<T>& level = tree.back();
+        std::vector<T> next((level.size() + 1) / 2);
+        parallel_for(static_cast<int>(next.size()), [&](int i) {
+            if (2 * i + 1 < static_cast<int>(level.size())) {
+                next[i] = level[2 * i] * level[2 * i + 1];
+            } else {
+                next[i] = level[2 * i];
+            }
+        });
+        tree.push_back(std::move(next));
+    }
+    return tree;
+}
+
+// x mod every leaf of the tree, reducing down one level at a time so each
+// division is by a modulus about the size of the remainder.
+template <class T>
+std::vector<T> remainder_tree(const T& x, const std::vector<std::vector<T>>& tree) {
+    if (tree.back().empty()) {
+        return std::vector<T>();
+    }
+    std::vector<T> rems(1, x % tree.back()[0]);
+    for (int l = static_cast<int>(tree.size()) - 2; l >= 0; l--) {
+        const std::vector<T>& level = tree[l];
+        std::vector<T> next(level.size());
+        parallel_for(static_cast<int>(level.size()), [&](int i) {
+            next[i] = rems[i / 2] % level[i];
+        });
+        rems = std::move(next);
+    }
+    return rems;
+}
+
+// Bernstein's batch gcd: gcd(n_i, prod_{j != i} n_j) for every modulus, from
+// the remainders of the full product modulo n_i^2.
+template <class T>
+std::vector<T> batch_gcd(const std::vector<T>& moduli) {
+    if (moduli.empty()) {
+        return std::vector<T>();
+    }
+    std::vector<std::vector<T>> tree = product_tree(moduli);
+    std::vector<T> rems(1, tree.back()[0]);
+    for (int l = static_cast<int>(tree.size()) - 2; l >= 0; l--) {
+        const std::vector<T>& level = tree[l];
+        std::vector<T> next(level.size());
+        parallel_for(static_cast<int>(level.size()), [&](int i) {
+            next[i] = rems[i / 2] % (level[i] * level[i]);
+        });
+        rems = std::move(next);
+    }
+    std::vector<T> gcds(moduli.size());
+    parallel_for(static_cast<int>(moduli.size()), [&](int i) {
+        gcds[i] = gcd(rems[i] / moduli[i], moduli[i]);
+    });
+    return gcds;
+}
+
+}
+
+}
+
+#endif //BIGINT_PRODUCT_TREE_HPP
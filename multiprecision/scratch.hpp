@@ -0,0 +1,133 @@
+#ifndef BIGINT_SCRATCH_HPP
+#define BIGINT_SCRATCH_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace hqythu {
+
+namespace bigint {
+
+// bump allocator for the temporaries of the raw_* kernels.
+// allocations are released in LIFO order through ScratchFrame. blocks are
+// kept once allocated, so after warm-up a thread does no heap allocation.
+// an arena can also be built over a caller supplied workspace, it only falls
+// back to the heap if the workspace turns out too small.
+class ScratchArena {
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    static const size_t alignment = 16;
+    static const size_t min_block_size = 1 << 16;
+
+    std::vector<Block> blocks;
+    std::vector<std::unique_ptr<char[]>> owned;
+    size_t block;
+    size_t offset;
+
+    static size_t align_up(size_t n) {
+        return (n + alignment - 1) / alignment * alignment;
+    }
+
+    void grow(size_t bytes) {
+        size_t size = bytes + alignment;
+        if (size < min_block_size) {
+            size = min_block_size;
+        }
+        if (!blocks.empty() && size < 2 * blocks.back().size) {
+            size = 2 * blocks.back().size;
+        }
+        owned.emplace_back(new char[size]);
+        blocks.push_back(Block{owned.back().get(), size});
+    }
+
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    ScratchArena() : block(0), offset(0) {}
+
+    ScratchArena(void* workspace, size_t bytes) : block(0), offset(0) {
+        blocks.push_back(Block{static_cast<char*>(workspace), bytes});
+    }
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator = (const ScratchArena&) = delete;
+
+    // the arena of the calling thread.
+    static ScratchArena& local() {
+        static thread_local ScratchArena arena;
+        return arena;
+    }
+
+    template <class T>
+    T* allocate(size_t n) {
+        size_t bytes = align_up(n * sizeof(T));
+        while (true) {
+            if (block < blocks.size()) {
+                Block& b = blocks[block];
+                size_t start = align_up(reinterpret_cast<size_t>(b.data) + offset) - reinterpret_cast<size_t>(b.data);
+                if (start + bytes <= b.size) {
+                    offset = start + bytes;
+                    return reinterpret_cast<T*>(b.data + start);
+                }
+                if (block + 1 < blocks.size()) {
+                    block++;
+                    offset = 0;
+                    continue;
+                }
+            }
+            grow(bytes);
+            block = blocks.size() - 1;
+            offset = 0;
+        }
+    }
+
+    Mark mark() const {
+        return Mark{block, offset};
+    }
+
+    void release(const Mark& m) {
+        assert(m.block < block || (m.block == block && m.offset <= offset));
+        block = m.block;
+        offset = m.offset;
+    }
+};
+
+// releases everything allocated from the arena during its lifetime.
+class ScratchFrame {
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark m;
+
+public:
+    explicit ScratchFrame(ScratchArena& arena) : arena(arena), m(arena.mark()) {}
+    ~ScratchFrame() { arena.release(m); }
+
+    ScratchFrame(const ScratchFrame&) = delete;
+    ScratchFrame& operator = (const ScratchFrame&) = delete;
+
+    template <class T>
+    T* allocate(size_t n) {
+        return arena.allocate<T>(n);
+    }
+};
+
+// upper bound in bytes of one allocation of n T's, alignment included.
+template <class T>
+size_t scratch_bytes(size_t n) {
+    return (n * sizeof(T) + 15) / 16 * 16 + 16;
+}
+
+}
+
+}
+
+#endif //BIGINT_SCRATCH_HPP
@@ -0,0 +1,52 @@
+//
+// signs of add, and of div and % on exact and inexact negative quotients,
+// for BigInt and scalar operands.
+// g++ -std=c++11 -pthread -I.. arithmetic_test.cpp && ./a.out
+//
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+
+#include "multiprecision/bigint.hpp"
+
+using namespace hqythu::bigint;
+
+typedef BigInt<256> big;
+
+int main() {
+    assert(big(3) + big(-5) == big(-2));
+    assert(big(-5) + big(3) == big(-2));
+    assert(big(-3) + big(5) == big(2));
+    assert(big(5) + big(-5) == 0u);
+
+    // floor division: the quotient rounds toward minus infinity and the
+    // remainder takes the sign of the divisor, exact quotients are exact.
+    assert(big(-6) / big(3) == big(-2));
+    assert(big(-6) % big(3) == 0u);
+    assert(big(6) / big(-3) == big(-2));
+    assert(big(6) % big(-3) == 0u);
+    assert(big(-6) / big(-3) == big(2));
+    assert(big(-7) / big(3) == big(-3));
+    assert(big(-7) % big(3) == big(2));
+    assert(big(7) / big(-3) == big(-3));
+    assert(big(7) % big(-3) == big(-2));
+    assert(big(-7) / big(-3) == big(2));
+    assert(big(-7) % big(-3) == big(-1));
+
+    // scalar divisors agree with BigInt ones, one limb or two.
+    assert(big(-6) % 3u == 0u);
+    assert(big(-7) % 3u == 2u);
+    assert(big(-6) / 3u == big(-2));
+    assert(big(-7) / 3u == big(-3));
+    const uint64_t wide = (static_cast<uint64_t>(1) << 40) + 3;
+    big w;
+    w.from_uint64(wide);
+    const big minus_6w = big(0) - big(6) * w;
+    assert(minus_6w % wide == 0u);
+    assert((minus_6w - big(1)) % wide == wide - 1);
+    assert(BigInt<256>(minus_6w % w) == 0u);
+
+    std::cout << "arithmetic test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,34 @@
+//
+// pow_crt against plain pow at double width, with primes of up to N / 2 bits.
+// g++ -std=c++11 -pthread -I.. crt_test.cpp && ./a.out
+//
+
+#include <cassert>
+#include <iostream>
+
+#include "multiprecision/bigint.hpp"
+
+using namespace hqythu::bigint;
+
+void check(const char* p_hex, const char* q_hex, int rounds) {
+    const BigInt<256> p(p_hex), q(q_hex);
+    const BigInt<512> n = BigInt<512>(p) * BigInt<512>(q);
+    for (int i = 0; i < rounds; i++) {
+        BigInt<512> d = BigInt<512>::random() % n;
+        BigInt<512> a = BigInt<512>::random() % n;
+        CRTParams<512> params = crt_params(d, p, q);
+        BigInt<1024> expected = pow(BigInt<1024>(a), BigInt<1024>(d), BigInt<1024>(n));
+        assert(BigInt<1024>(pow_crt(a, params)) == expected);
+    }
+}
+
+int main() {
+    check("aa2c00ee2b3f37e74ee443885", "c4afbd4dc96f22d0ef9b5c0f7", 8);
+    check("9b42ce138254b451b359534beaade62f31877d69249bb464e3",
+          "efa1d335a20dc3f6462ed78b73c613f1c70a3b930dd0811215", 8);
+    check("e3a6a79c6494df6e90178de326421ef6e6e8c63b32bbb12938011ec19f98d793",
+          "df58499d4ef8152a4bed8679e734720d465b59379e30a081c2b8fd2736139019", 8);
+
+    std::cout << "crt test passed" << std::endl;
+    return 0;
+}
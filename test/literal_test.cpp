@@ -0,0 +1,26 @@
+//
+// compile-time _big literals, including a 4096 bit one.
+// g++ -std=c++11 -pthread -I.. literal_test.cpp && ./a.out
+//
+
+#include <cassert>
+#include <iostream>
+
+#include "multiprecision/bigint.hpp"
+
+using namespace hqythu::bigint;
+using namespace hqythu::bigint::literals;
+
+int main() {
+    constexpr auto small = 0x1234567890abcdef_big;
+    static_assert(small.limb(0) == 0x90abcdefu && small.limb(1) == 0x12345678u, "limbs of a 64 bit literal");
+    assert(BigInt<128>(small) == BigInt<128>("1234567890abcdef"));
+
+    constexpr auto big = 0xc314a3cc4f37a85ad8bd80f0f176c4e9686683713a3acb1aeeeeeef9680a01d74c16a634864be45595aa58f51ab4e997845e4a564ca73531ea436ac111886a604fa323cb4bd21ffe282785913bddd3e723e0c69e4677099b71a9c2e5218158c15cd6b5ae763f7dfedd8f46a36b89dd667974e582fafa7a40d3f1d70fbdad46218535d351171b9d53e84dbfe9dd8b0328737dfbed578b3a15e8038350c6cdb165c7e1e3d667ccaafb2cbab094caa9bd3532a26b31e83eeb30e9d982d1486bb01194ca08211df5a7ff6a386a8d47e507ef71ca0adccfc71f2f132bbc73bfaa8f6cabd8121694bf41eb1ca7f416d0b02c30af1e61863f9a1fa93c73cfa56c84a0568b20b2b36458eb40b7e481cb92bcbdda2191ca539b751bf62de04539890800a173ff6eed34bca2b336796a5e50589cc961b0c46e4abdb5ca4f5c99c3a2fe1739dfa01aed96bb17562ab01b1fef0a3dc163015710cceb48b30f4a8a18d6be75b0b477a0778d4d45d6bd64b0f24155e48a5e8416160facfb49cd1d47f2161e84d3861abd5dc0ae699527aae362c6c0ac72006037d09c4f525558d9e5b64633e8a518b3cf3527a280ccd291a42182fd56459584375618334edc57548d5f4e620f38f49b20846c9025f8108797d6f2e7351df45ed8c55d5cb4226399227ae1d6f9f507a81949e60d93473ab434fed7e439fe07158ab795f381835b6913cd87684f34_big;
+    static_assert(sizeof(big.limbs) == 4096 / 8, "a 4096 bit literal has 128 limbs");
+    static_assert(big.limb(0) == 0x87684f34u && big.limb(127) == 0xc314a3ccu, "limbs of a 4096 bit literal");
+    assert(BigInt<4096>(big).to_hex_string() == "c314a3cc4f37a85ad8bd80f0f176c4e9686683713a3acb1aeeeeeef9680a01d74c16a634864be45595aa58f51ab4e997845e4a564ca73531ea436ac111886a604fa323cb4bd21ffe282785913bddd3e723e0c69e4677099b71a9c2e5218158c15cd6b5ae763f7dfedd8f46a36b89dd667974e582fafa7a40d3f1d70fbdad46218535d351171b9d53e84dbfe9dd8b0328737dfbed578b3a15e8038350c6cdb165c7e1e3d667ccaafb2cbab094caa9bd3532a26b31e83eeb30e9d982d1486bb01194ca08211df5a7ff6a386a8d47e507ef71ca0adccfc71f2f132bbc73bfaa8f6cabd8121694bf41eb1ca7f416d0b02c30af1e61863f9a1fa93c73cfa56c84a0568b20b2b36458eb40b7e481cb92bcbdda2191ca539b751bf62de04539890800a173ff6eed34bca2b336796a5e50589cc961b0c46e4abdb5ca4f5c99c3a2fe1739dfa01aed96bb17562ab01b1fef0a3dc163015710cceb48b30f4a8a18d6be75b0b477a0778d4d45d6bd64b0f24155e48a5e8416160facfb49cd1d47f2161e84d3861abd5dc0ae699527aae362c6c0ac72006037d09c4f525558d9e5b64633e8a518b3cf3527a280ccd291a42182fd56459584375618334edc57548d5f4e620f38f49b20846c9025f8108797d6f2e7351df45ed8c55d5cb4226399227ae1d6f9f507a81949e60d93473ab434fed7e439fe07158ab795f381835b6913cd87684f34");
+
+    std::cout << "literal test passed" << std::endl;
+    return 0;
+}
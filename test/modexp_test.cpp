@@ -0,0 +1,97 @@
+//
+// Barrett exponentiation and ModExpEngine against plain pow, with moduli of
+// exactly N / 2 and N bits, and the engine's error paths.
+// g++ -std=c++11 -pthread -I.. modexp_test.cpp && ./a.out
+//
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "multiprecision/bigint.hpp"
+
+using namespace hqythu::bigint;
+
+// a random odd modulus of exactly k bits.
+template <int N>
+BigInt<N> modulus_of_bits(int k) {
+    BigInt<N> n = (BigInt<N>::random() >> (N - k + 1)) + (BigInt<N>(1) << (k - 1));
+    return n % 2u == 0u ? n + 1u : n;
+}
+
+template <int N>
+void check_pow(int k, int rounds) {
+    for (int i = 0; i < rounds; i++) {
+        BigInt<N> n = modulus_of_bits<N>(k);
+        assert(n.get_bit_length() == k);
+        BarrettReducer<N> reducer(n);
+        for (int j = 0; j < 4; j++) {
+            BigInt<N> a = BigInt<N>::random() >> (N - k - 4);
+            BigInt<N> d = BigInt<N>::random() >> (N - 128);
+            BigInt<2 * N> expected = pow(BigInt<2 * N>(a), BigInt<2 * N>(d), BigInt<2 * N>(n));
+            assert(BigInt<2 * N>(pow(a, d, reducer)) == expected);
+        }
+    }
+}
+
+template <int N>
+void check_engine(int k) {
+    typename ModExpEngine<N>::Config config;
+    config.threads = 2;
+    ModExpEngine<N> engine(config);
+    BigInt<N> n = modulus_of_bits<N>(k);
+    std::vector<BigInt<N>> as;
+    std::vector<std::future<BigInt<N>>> results;
+    BigInt<N> d = BigInt<N>::random() >> (N - 64);
+    for (int i = 0; i < 8; i++) {
+        as.push_back(BigInt<N>::random() >> (N - k + 1));
+        results.push_back(engine.submit(as.back(), d, n));
+    }
+    for (int i = 0; i < 8; i++) {
+        BigInt<2 * N> expected = pow(BigInt<2 * N>(as[i]), BigInt<2 * N>(d), BigInt<2 * N>(n));
+        assert(BigInt<2 * N>(results[i].get()) == expected);
+    }
+}
+
+// callbacks get the result, and a zero modulus is refused at submission.
+void check_engine_errors() {
+    ModExpEngine<256> engine;
+    std::promise<BigInt<256>> got;
+    engine.submit(BigInt<256>(3), BigInt<256>(5), BigInt<256>(7),
+                  [&got](const BigInt<256>& r, std::exception_ptr error) {
+                      assert(!error);
+                      got.set_value(r);
+                  });
+    assert(got.get_future().get() == 5u);
+
+    bool thrown = false;
+    try {
+        engine.submit(BigInt<256>(3), BigInt<256>(5), BigInt<256>(0));
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        engine.try_submit(BigInt<256>(3), BigInt<256>(5), BigInt<256>(-7),
+                          [](const BigInt<256>&, std::exception_ptr) { assert(false); });
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main() {
+    check_pow<1024>(512, 8);
+    check_pow<1024>(1024, 8);
+    check_pow<1024>(77, 8);
+    check_pow<4096>(2048, 2);
+    check_pow<4096>(4096, 1);
+    check_engine<1024>(512);
+    check_engine<4096>(2048);
+    check_engine_errors();
+
+    std::cout << "modexp test passed" << std::endl;
+    return 0;
+}
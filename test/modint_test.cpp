@@ -0,0 +1,60 @@
+//
+// ModInt with the special-form primes and a 1024 bit generic modulus,
+// against BigInt arithmetic at double width.
+// g++ -std=c++11 -pthread -I.. modint_test.cpp && ./a.out
+//
+
+#include <cassert>
+#include <iostream>
+
+#include "multiprecision/bigint.hpp"
+
+using namespace hqythu::bigint;
+
+// a random odd 1024 bit modulus, written limb by limb like the policies in
+// modint.hpp.
+struct Generic1024 : GenericModulus {
+    static constexpr int bits = 1024;
+    static constexpr int limbs = 32;
+    static constexpr uint32_t limb(int i) {
+        return limb_at(i, 0xcc0b9271, 0x04e5f7cf, 0x7bc694eb, 0xd991a72b, 0x63b18a93, 0x52be468a,
+                       0xd45434de, 0xcae9a673, 0xded4b961, 0x85106fdc, 0x19b61d44, 0x71f36ec2,
+                       0x834c0f25, 0x5dab7e5e, 0xf4eac10f, 0xced7384b, 0xb8c92a67, 0xce9af45c,
+                       0xb749bdee, 0x5e6b64bf, 0x636e22c5, 0xcb46d03f, 0xfb6e77ed, 0x1894934c,
+                       0xb620d9a0, 0xbeaf95cc, 0xdfaab154, 0x23e12368, 0xcc32d94a, 0x63b7e6c6,
+                       0x1a2fb798, 0xe8dd7cad);
+    }
+};
+
+template <int N, class Modulus>
+void check(int rounds) {
+    typedef ModInt<N, Modulus> mod_int;
+    const BigInt<2 * N> m(mod_int::modulus());
+    for (int i = 0; i < rounds; i++) {
+        BigInt<N> a = BigInt<N>::random() % mod_int::modulus();
+        BigInt<N> b = BigInt<N>::random() % mod_int::modulus();
+        BigInt<2 * N> a_(a), b_(b);
+        mod_int x(a), y(b);
+        assert(BigInt<2 * N>(x.value()) == a_);
+        assert(BigInt<2 * N>((x + y).value()) == (a_ + b_) % m);
+        assert(BigInt<2 * N>((x - y).value()) == (a_ - b_ + m) % m);
+        assert(BigInt<2 * N>((x * y).value()) == (a_ * b_) % m);
+        assert(BigInt<2 * N>(x.sqr().value()) == (a_ * a_) % m);
+    }
+}
+
+int main() {
+    static_assert(MontgomeryConstants<Generic1024>::r2.limb(31) != 0 ||
+                  MontgomeryConstants<Generic1024>::r2.limb(30) != 0, "R^2 mod m is a constant expression");
+    const BigInt<4096> m(ModInt<1024, Generic1024>::modulus());
+    assert(BigInt<4096>(MontgomeryConstants<Generic1024>::r2) == (BigInt<4096>(1) << 2048) % m);
+
+    check<256, Curve25519Prime>(200);
+    check<256, Secp256k1Prime>(200);
+    check<256, P256Prime>(200);
+    check<128, Mersenne127Prime>(200);
+    check<1024, Generic1024>(50);
+
+    std::cout << "modint test passed" << std::endl;
+    return 0;
+}
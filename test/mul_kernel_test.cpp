@@ -0,0 +1,46 @@
+//
+// differential test of raw_mul against the portable reference loop.
+// g++ -std=c++11 -pthread -I.. mul_kernel_test.cpp && ./a.out
+//
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "multiprecision/bigint.hpp"
+
+int main() {
+    std::mt19937 engine(2016);
+    std::uniform_int_distribution<uint32_t> limb;
+    int cases = 0;
+    for (int a_len = 1; a_len <= 41; a_len++) {
+        for (int b_len = 1; b_len <= 41; b_len += 3) {
+            for (int max_len : {1, a_len, b_len, a_len + b_len - 1, a_len + b_len}) {
+                std::vector<uint32_t> a(a_len), b(b_len);
+                for (auto& x : a) {
+                    x = limb(engine);
+                }
+                for (auto& x : b) {
+                    x = limb(engine);
+                }
+                // all-ones operands maximize the carries.
+                if (cases % 7 == 0) {
+                    std::fill(a.begin(), a.end(), 0xffffffffu);
+                    std::fill(b.begin(), b.end(), 0xffffffffu);
+                }
+                a[a_len - 1] |= 1;
+                b[b_len - 1] |= 1;
+                std::vector<uint32_t> expect(max_len), got(max_len);
+                int expect_len = raw_mul_portable<uint32_t, uint64_t>(a.data(), a_len, b.data(), b_len,
+                                                                      expect.data(), max_len);
+                int got_len = raw_mul<uint32_t, uint64_t>(a.data(), a_len, b.data(), b_len, got.data(), max_len);
+                assert(got_len == expect_len);
+                assert(got == expect);
+                cases++;
+            }
+        }
+    }
+    std::cout << cases << " cases passed" << std::endl;
+    return 0;
+}
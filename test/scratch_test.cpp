@@ -0,0 +1,66 @@
+//
+// raw_mul_karatsuba within a workspace of exactly
+// raw_mul_karatsuba_scratch_size bytes makes no heap allocation.
+// g++ -std=c++11 -pthread -I.. scratch_test.cpp && ./a.out
+//
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "multiprecision/bigint.hpp"
+
+static std::atomic<long> allocations(0);
+
+void* operator new(size_t n) {
+    allocations++;
+    if (void* p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using namespace hqythu::bigint;
+
+int main() {
+    std::mt19937 engine(2016);
+    std::uniform_int_distribution<uint32_t> limb;
+    std::uniform_int_distribution<int> length(1, 400);
+    for (int t = 0; t < 2000; t++) {
+        int a_len = t == 0 ? 246 : length(engine);
+        int b_len = t == 0 ? 340 : length(engine);
+        int max_len = t == 0 ? 125 : std::uniform_int_distribution<int>(1, a_len + b_len)(engine);
+        std::vector<uint32_t> a(a_len), b(b_len), r(max_len), expected(max_len);
+        for (auto& x : a) {
+            x = limb(engine);
+        }
+        for (auto& x : b) {
+            x = limb(engine);
+        }
+        a.back() |= 1;
+        b.back() |= 1;
+        // zero limbs in the middle make the halves normalize shorter.
+        if (t % 3 == 1) {
+            std::fill(a.begin() + a_len / 2, a.end() - 1, 0);
+        }
+
+        size_t bytes = raw_mul_karatsuba_scratch_size(a_len, b_len, max_len, sizeof(uint32_t));
+        std::vector<char> workspace(bytes);
+        ScratchArena arena(workspace.data(), bytes);
+        long before = allocations;
+        raw_mul_karatsuba<uint32_t, uint64_t>(a.data(), a_len, b.data(), b_len, r.data(), max_len, arena);
+        assert(allocations == before);
+
+        raw_mul_portable<uint32_t, uint64_t>(a.data(), a_len, b.data(), b_len, expected.data(), max_len);
+        assert(r == expected);
+    }
+
+    std::cout << "scratch test passed" << std::endl;
+    return 0;
+}